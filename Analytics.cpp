@@ -1,35 +1,194 @@
 #include "Analytics.h"
 #include <GL/glut.h>
-#include <cstdio>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cmath>
 #include "Utils.h"
+#include "Text.h"
+#include "Profiler.h"
 
 namespace Analytics {
     
+    // --- Histograms ---
+    namespace {
+        int bucketIndex(unsigned us) {
+            if (us == 0) us = 1;
+            int e = 31 - __builtin_clz(us); // floor(log2)
+            int sub = (e >= HIST_SUB_BITS) ? (us >> (e - HIST_SUB_BITS)) : (us << (HIST_SUB_BITS - e));
+            sub &= HIST_SUB_BUCKETS - 1;
+            return std::min(HIST_BUCKETS - 1, e * HIST_SUB_BUCKETS + sub);
+        }
+        
+        // Midpoint of a bucket, in microseconds
+        float bucketValue(int index) {
+            int e = index / HIST_SUB_BUCKETS;
+            int sub = index % HIST_SUB_BUCKETS;
+            float lower = std::ldexp(float(HIST_SUB_BUCKETS + sub), e - HIST_SUB_BITS);
+            float width = std::ldexp(1.0f, e - HIST_SUB_BITS);
+            return lower + width * 0.5f;
+        }
+        
+        Percentiles percentiles(const unsigned* buckets, unsigned long long total, unsigned maxUs) {
+            Percentiles p = { 0, 0, 0, maxUs * 0.001f };
+            if (total == 0) return p;
+            
+            const double q[3] = { 0.50, 0.95, 0.99 };
+            float* dst[3] = { &p.p50, &p.p95, &p.p99 };
+            unsigned long long seen = 0;
+            int k = 0;
+            for (int i = 0; i < HIST_BUCKETS && k < 3; i++) {
+                seen += buckets[i];
+                while (k < 3 && seen >= (unsigned long long)(q[k] * total + 0.5)) {
+                    *dst[k] = std::min(bucketValue(i), float(maxUs)) * 0.001f;
+                    k++;
+                }
+            }
+            return p;
+        }
+    }
+    
+    void resetHistogram(Histogram& h) {
+        std::fill(h.window, h.window + HIST_BUCKETS, 0u);
+        std::fill(h.lifetime, h.lifetime + HIST_BUCKETS, 0u);
+        h.recentHead = 0;
+        h.recentCount = 0;
+        h.lifetimeMax = 0;
+        h.lifetimeCount = 0;
+    }
+    
+    void addSample(Histogram& h, long long ns) {
+        unsigned us = unsigned(std::min(ns / 1000, 0xFFFFFFFFLL));
+        
+        // Slide the window: evict the oldest sample once full
+        if (h.recentCount == HIST_WINDOW) {
+            h.window[bucketIndex(h.recent[h.recentHead])]--;
+        } else {
+            h.recentCount++;
+        }
+        h.recent[h.recentHead] = us;
+        h.recentHead = (h.recentHead + 1) % HIST_WINDOW;
+        
+        int b = bucketIndex(us);
+        h.window[b]++;
+        h.lifetime[b]++;
+        h.lifetimeCount++;
+        h.lifetimeMax = std::max(h.lifetimeMax, us);
+    }
+    
+    Percentiles windowPercentiles(const Histogram& h) {
+        unsigned maxUs = 0;
+        for (int i = 0; i < h.recentCount; i++) maxUs = std::max(maxUs, h.recent[i]);
+        return percentiles(h.window, h.recentCount, maxUs);
+    }
+    
+    Percentiles lifetimePercentiles(const Histogram& h) {
+        return percentiles(h.lifetime, h.lifetimeCount, h.lifetimeMax);
+    }
+    
+    void dumpHistograms(const Metrics& m, FILE* out) {
+        const Histogram* hists[2] = { &m.frameTimes, &m.tickTimes };
+        const char* names[2] = { "frame", "tick" };
+        
+        fprintf(out, "--- Timing histograms (ms) ---\n");
+        for (int i = 0; i < 2; i++) {
+            Percentiles w = windowPercentiles(*hists[i]);
+            Percentiles l = lifetimePercentiles(*hists[i]);
+            fprintf(out, "%-5s samples=%llu  last %d: p50=%.2f p95=%.2f p99=%.2f max=%.2f  lifetime: p50=%.2f p95=%.2f p99=%.2f max=%.2f\n",
+                    names[i], hists[i]->lifetimeCount, hists[i]->recentCount,
+                    w.p50, w.p95, w.p99, w.max, l.p50, l.p95, l.p99, l.max);
+        }
+        
+        // Non-empty lifetime buckets of the frame histogram: "mid_ms count"
+        for (int i = 0; i < HIST_BUCKETS; i++) {
+            if (m.frameTimes.lifetime[i] == 0) continue;
+            fprintf(out, "frame_bucket %.3f %u\n", bucketValue(i) * 0.001f, m.frameTimes.lifetime[i]);
+        }
+    }
+    
     void init(Metrics& m) {
         m.fps = 60.0f;
         m.frameTime = 16.6f;
+        m.tickTime = 0.0f;
         m.entityCount = 0;
         m.particleCount = 0;
+        m.population = Population();
         m.memoryUsage = 0.0f;
+        m.memoryPeak = 0.0f;
+        m.processRSS = 0.0f;
+        m.glBatches = m.glVertices = m.glStateChanges = m.glRedundant = 0;
+        m.chunksLive = m.chunksStored = m.chunksUnvisited = 0;
+        resetHistogram(m.frameTimes);
+        resetHistogram(m.tickTimes);
         m.active = false;
         m.showHeatmap = false;
+        m.showProfiler = true;
     }
     
-    void update(Metrics& m, int entCount, int partCount) {
-        // Compute FPS (Simple approximation based on timer)
-        static int lastTime = 0;
-        int currentTime = glutGet(GLUT_ELAPSED_TIME);
-        float dt = (currentTime - lastTime) * 0.001f;
-        lastTime = currentTime;
+    void update(Metrics& m, const Population& pop, int partCount) {
+        // Compute FPS (EMA) and record the frame interval
+        static long long lastNs = 0;
+        long long currentNs = Profiler::nowNs();
+        long long deltaNs = lastNs ? currentNs - lastNs : 0;
+        lastNs = currentNs;
+        float dt = deltaNs * 1e-9f;
         
-        if (dt > 0) m.fps = 0.9f * m.fps + 0.1f * (1.0f / dt);
-        m.frameTime = dt * 1000.0f;
+        if (dt > 0) {
+            m.fps = 0.9f * m.fps + 0.1f * (1.0f / dt);
+            m.frameTime = dt * 1000.0f;
+            addSample(m.frameTimes, deltaNs);
+        }
         
-        m.entityCount = entCount;
+        m.entityCount = pop.villagers + pop.animals;
+        m.population = pop;
         m.particleCount = partCount;
-        m.memoryUsage = entCount * 0.05f + partCount * 0.001f; // Simulated MB
+        
+        const float MB = 1.0f / (1024.0f * 1024.0f);
+        m.memoryUsage = MemoryTracker::totalLiveBytes() * MB;
+        m.memoryPeak = MemoryTracker::totalPeakBytes() * MB;
+        
+        GLStats::Counts gl = GLStats::frameTotals();
+        m.glBatches = gl.batches;
+        m.glVertices = gl.vertices;
+        m.glStateChanges = gl.stateChanges;
+        m.glRedundant = gl.redundant;
+        
+        // RSS needs a syscall / file read, sample it twice a second
+        static int rssCountdown = 0;
+        if (--rssCountdown <= 0) {
+            m.processRSS = MemoryTracker::processRSS() * MB;
+            rssCountdown = 30;
+        }
+    }
+    
+    void recordTick(Metrics& m, long long tickNs) {
+        m.tickTime = tickNs * 1e-6f;
+        addSample(m.tickTimes, tickNs);
+    }
+    
+    void publishTelemetry(const Metrics& m, Telemetry::Record& r) {
+        if (!Telemetry::isOpen()) return;
+        
+        r.timestampNs = Profiler::nowNs();
+        r.fps = m.fps;
+        r.frameTimeMs = m.frameTime;
+        r.tickTimeMs = m.tickTime;
+        r.tickP99Ms = windowPercentiles(m.tickTimes).p99;
+        r.memoryMB = m.memoryUsage;
+        r.particles = m.particleCount;
+        
+        static std::vector<Profiler::StageStats> stages;
+        Profiler::getStats(stages);
+        r.stageCount = 0;
+        for (const auto& st : stages) {
+            if (r.stageCount == Telemetry::MAX_STAGES) break;
+            Telemetry::Stage& out = r.stages[r.stageCount++];
+            snprintf(out.name, sizeof(out.name), "%s", st.name);
+            out.depth = st.depth;
+            out.ms = st.lastMs;
+        }
+        
+        Telemetry::publish(r);
     }
     
     void draw(const Metrics& m, int width, int height) {
@@ -48,59 +207,293 @@ namespace Analytics {
         glColor4f(0.0f, 0.0f, 0.0f, 0.7f);
         glBegin(GL_QUADS);
         glVertex2f(10, height - 10);
-        glVertex2f(220, height - 10);
-        glVertex2f(220, height - 120);
-        glVertex2f(10, height - 120);
+        glVertex2f(260, height - 10);
+        glVertex2f(260, height - 210);
+        glVertex2f(10, height - 210);
         glEnd();
         
-        glColor3f(0.0f, 1.0f, 0.2f);
-        char buffer[128];
-        void* font = GLUT_BITMAP_HELVETICA_12;
+        // Text (one batched draw from the glyph atlas)
+        const Utils::Color title(0.0f, 1.0f, 0.2f);
+        const Utils::Color value(1.0f, 1.0f, 1.0f);
+        const Utils::Color hint(0.5f, 0.5f, 0.5f);
         
-        sprintf(buffer, "SIMULATION ANALYTICS [ON]");
-        glRasterPos2f(15, height - 25);
-        for(char* c = buffer; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+        TextRenderer::add(15, height - 25, "SIMULATION ANALYTICS [ON]", title);
+        TextRenderer::addf(15, height - 40, value, "FPS: %.1f", m.fps);
+        TextRenderer::addf(15, height - 55, value, "Entities: %d (V %d A %d H %d E %d)", m.entityCount,
+                           m.population.villagers, m.population.animals, m.population.houses, m.population.emitters);
+        TextRenderer::addf(15, height - 70, value, "Particles: %d", m.particleCount);
+        TextRenderer::addf(15, height - 85, value, "Sim Mem: %.2f MB (peak %.2f) RSS %.1f", m.memoryUsage, m.memoryPeak, m.processRSS);
+        
+        // Percentiles over the last ~10s: p50 / p95 / p99 / max
+        Percentiles fp = windowPercentiles(m.frameTimes);
+        Percentiles tp = windowPercentiles(m.tickTimes);
+        TextRenderer::addf(15, height - 100, value, "Frame: %.1f/%.1f/%.1f/%.1f", fp.p50, fp.p95, fp.p99, fp.max);
+        TextRenderer::addf(15, height - 115, value, "Tick:  %.2f/%.2f/%.2f/%.2f", tp.p50, tp.p95, tp.p99, tp.max);
+        TextRenderer::addf(15, height - 130, value, "GL: %d batches %d verts %d state (%d redundant)",
+                           m.glBatches, m.glVertices, m.glStateChanges, m.glRedundant);
+        if (m.chunksLive > 0) {
+            TextRenderer::addf(15, height - 145, value, "Chunks: %d live %d stored %d unvisited", m.chunksLive, m.chunksStored, m.chunksUnvisited);
+        } else {
+            TextRenderer::add(15, height - 145, "Chunks: whole world live", value);
+        }
+        TextRenderer::add(15, height - 165, "G: Overlay | H: Heatmap | P: Profiler", hint);
+        TextRenderer::add(15, height - 180, "V/A/O/E: Spawn (Shift: Remove) | [ ]: Batch", hint);
+        TextRenderer::add(15, height - 195, ", . < >: Pan | R: Camera tour", hint);
+        TextRenderer::flush();
         
-        glColor3f(1.0f, 1.0f, 1.0f);
-        sprintf(buffer, "FPS: %.1f", m.fps);
-        glRasterPos2f(15, height - 40);
-        for(char* c = buffer; *c != '\0'; c++) glutBitmapCharacter(font, *c);
-
-        sprintf(buffer, "Entities: %d", m.entityCount);
-        glRasterPos2f(15, height - 55);
-        for(char* c = buffer; *c != '\0'; c++) glutBitmapCharacter(font, *c);
-
-        sprintf(buffer, "Particles: %d", m.particleCount);
-        glRasterPos2f(15, height - 70);
-        for(char* c = buffer; *c != '\0'; c++) glutBitmapCharacter(font, *c);
-
-        sprintf(buffer, "Sim Mem: %.2f MB", m.memoryUsage);
-        glRasterPos2f(15, height - 85);
-        for(char* c = buffer; *c != '\0'; c++) glutBitmapCharacter(font, *c);
-        
-        glColor3f(0.5f, 0.5f, 0.5f);
-        sprintf(buffer, "F1: Toggle Overlay | F2: Heatmap");
-        glRasterPos2f(15, height - 105);
-        for(char* c = buffer; *c != '\0'; c++) glutBitmapCharacter(font, *c);
-
         glDisable(GL_BLEND);
+        
+        if (m.showProfiler) {
+            drawProfiler(width, height - 220);
+            drawMemory(width, height - 10);
+            drawGLStats(width, height - 10 - 14 * (MemoryTracker::TAG_COUNT + 1) - 20);
+        }
     }
     
-    // Draw population heatmap (to be called in World Space context but from Scene)
-    void drawHeatmap(const std::vector<float>& entityX, const std::vector<float>& entityY) {
+    void drawGLStats(int width, int top) {
+        // Per-section GL submission of the last frame (innermost profiler scope)
+        static std::vector<GLStats::SectionCounts> sections;
+        GLStats::getSections(sections);
+        if (sections.empty()) return;
+        
+        const float rowH = 14.0f;
+        float left = width - 250.0f;
+        float bottom = top - rowH * (sections.size() + 1) - 10;
+        
         glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive Glow
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glColor4f(0.0f, 0.0f, 0.0f, 0.7f);
+        glBegin(GL_QUADS);
+        glVertex2f(left, top); glVertex2f(width - 10.0f, top);
+        glVertex2f(width - 10.0f, bottom); glVertex2f(left, bottom);
+        glEnd();
         
-        for (float x : entityX) {
-            // Heatmap Blob
-            for (float r = 5.0f; r > 0; r -= 1.0f) {
-                glColor4f(1.0f, 0.0f, 0.0f, 0.1f); 
-                Utils::drawCircle(r, x, 5.0f /* Ground level approx */, 12, true);
-            }
+        const Utils::Color header(0.0f, 1.0f, 0.2f);
+        const Utils::Color value(0.9f, 0.9f, 0.9f);
+        float y = top - 5 - rowH + 3;
+        TextRenderer::add(left + 5, y, "GL         batch  verts  state  redund", header);
+        for (const auto& s : sections) {
+            y -= rowH;
+            TextRenderer::add(left + 5, y, s.name, value);
+            TextRenderer::addf(left + 75, y, value, "%5d %6d %6d %6d",
+                               s.counts.batches, s.counts.vertices, s.counts.stateChanges, s.counts.redundant);
+        }
+        TextRenderer::flush();
+        
+        glDisable(GL_BLEND);
+    }
+    
+    void drawMemory(int width, int top) {
+        // Per-subsystem table, top right: live KB / peak KB / allocations last tick
+        const float rowH = 14.0f;
+        float left = width - 250.0f;
+        float bottom = top - rowH * (MemoryTracker::TAG_COUNT + 1) - 10;
+        
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glColor4f(0.0f, 0.0f, 0.0f, 0.7f);
+        glBegin(GL_QUADS);
+        glVertex2f(left, top); glVertex2f(width - 10.0f, top);
+        glVertex2f(width - 10.0f, bottom); glVertex2f(left, bottom);
+        glEnd();
+        
+        const Utils::Color header(0.0f, 1.0f, 0.2f);
+        const Utils::Color value(0.9f, 0.9f, 0.9f);
+        const Utils::Color churn(1.0f, 0.5f, 0.3f);
+        float y = top - 5 - rowH + 3;
+        TextRenderer::add(left + 5, y, "Memory     live KB  peak KB  alloc/tick", header);
+        for (int t = 0; t < MemoryTracker::TAG_COUNT; ++t) {
+            MemoryTracker::TagStats s = MemoryTracker::getStats(t);
+            y -= rowH;
+            TextRenderer::add(left + 5, y, MemoryTracker::tagName(t), value);
+            TextRenderer::addf(left + 75, y, s.tickAllocs > 0 ? churn : value, "%8.1f %8.1f %6lld",
+                               s.liveBytes / 1024.0f, s.peakBytes / 1024.0f, s.tickAllocs);
         }
+        TextRenderer::flush();
         
         glDisable(GL_BLEND);
+    }
+    
+    void drawProfiler(int width, int top) {
+        // Per-stage timing bars (min/avg/max over the profiler history)
+        static std::vector<Profiler::StageStats> stats;
+        Profiler::getStats(stats);
+        if (stats.empty()) return;
+        
+        const float rowH = 14.0f;
+        const float barX = 110.0f;
+        const float barW = 100.0f;
+        const float budgetMs = 16.6f; // Full bar = one 60Hz frame
+        float bottom = top - rowH * stats.size() - 10;
+        
+        glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        
+        // Background + bars in one immediate batch
+        glBegin(GL_QUADS);
+        glColor4f(0.0f, 0.0f, 0.0f, 0.7f);
+        glVertex2f(10, top); glVertex2f(330, top);
+        glVertex2f(330, bottom); glVertex2f(10, bottom);
+        
+        for (size_t i = 0; i < stats.size(); ++i) {
+            const Profiler::StageStats& s = stats[i];
+            float y = top - 5 - rowH * (i + 1);
+            float wMin = std::min(1.0f, s.minMs / budgetMs) * barW;
+            float wAvg = std::min(1.0f, s.avgMs / budgetMs) * barW;
+            float wMax = std::min(1.0f, s.maxMs / budgetMs) * barW;
+            
+            // Max (faint), Avg (solid), Min (bright core)
+            glColor4f(1.0f, 0.3f, 0.2f, 0.35f);
+            glVertex2f(barX, y + 2); glVertex2f(barX + wMax, y + 2);
+            glVertex2f(barX + wMax, y + 10); glVertex2f(barX, y + 10);
+            glColor4f(1.0f, 0.8f, 0.2f, 0.8f);
+            glVertex2f(barX, y + 3); glVertex2f(barX + wAvg, y + 3);
+            glVertex2f(barX + wAvg, y + 9); glVertex2f(barX, y + 9);
+            glColor4f(0.2f, 1.0f, 0.3f, 0.9f);
+            glVertex2f(barX, y + 4); glVertex2f(barX + wMin, y + 4);
+            glVertex2f(barX + wMin, y + 8); glVertex2f(barX, y + 8);
+        }
+        glEnd();
+        
+        const Utils::Color label(0.9f, 0.9f, 0.9f);
+        const Utils::Color value(0.7f, 0.7f, 0.7f);
+        for (size_t i = 0; i < stats.size(); ++i) {
+            const Profiler::StageStats& s = stats[i];
+            float y = top - 5 - rowH * (i + 1) + 3;
+            TextRenderer::add(15 + s.depth * 8.0f, y, s.name, label);
+            TextRenderer::addf(barX + barW + 5, y, value, "%.2f/%.2f/%.2f", s.minMs, s.avgMs, s.maxMs);
+        }
+        TextRenderer::flush();
+        
+        glDisable(GL_BLEND);
+    }
+    
+    // --- Population Heatmap ---
+    namespace {
+        const int HM_COLS = 60;
+        const int HM_ROWS = 32;
+        const float HM_X0 = -30.0f;
+        const float HM_Y0 = 0.0f;
+        const float HM_CELL = 2.0f;
+        const int HM_VERTS = (HM_COLS + 1) * (HM_ROWS + 1);
+        
+        const float HM_DECAY = 0.998f; // Per tick, half-life ~6s at 60Hz
+        const float HM_MIN_PEAK = 50.0f; // Keeps a lone entity from saturating the ramp
+        
+        MemoryTracker::Vector<GLfloat, MemoryTracker::RENDER> hmPositions;
+        MemoryTracker::Vector<GLuint, MemoryTracker::RENDER> hmIndices;
+        MemoryTracker::Vector<GLfloat, MemoryTracker::RENDER> hmColors;
+        
+        void buildHeatmapGrid() {
+            hmPositions.resize(HM_VERTS * 2);
+            for (int row = 0; row <= HM_ROWS; ++row) {
+                for (int col = 0; col <= HM_COLS; ++col) {
+                    int v = row * (HM_COLS + 1) + col;
+                    hmPositions[v * 2] = HM_X0 + col * HM_CELL;
+                    hmPositions[v * 2 + 1] = HM_Y0 + row * HM_CELL;
+                }
+            }
+            
+            hmIndices.reserve(HM_COLS * HM_ROWS * 6);
+            for (int row = 0; row < HM_ROWS; ++row) {
+                for (int col = 0; col < HM_COLS; ++col) {
+                    GLuint v = row * (HM_COLS + 1) + col;
+                    GLuint up = v + (HM_COLS + 1);
+                    hmIndices.push_back(v); hmIndices.push_back(v + 1); hmIndices.push_back(up + 1);
+                    hmIndices.push_back(v); hmIndices.push_back(up + 1); hmIndices.push_back(up);
+                }
+            }
+            
+            hmColors.resize(HM_VERTS * 4);
+        }
+    }
+    
+    void initHeatmap(Heatmap& h) {
+        h.density.assign(HM_VERTS, 0.0f);
+        h.peak = HM_MIN_PEAK;
+        h.originX = HM_X0;
+    }
+    
+    void followHeatmap(Heatmap& h, float offsetX) {
+        float originX = HM_X0 + floorf(offsetX / HM_CELL) * HM_CELL;
+        int shift = int(lroundf((originX - h.originX) / HM_CELL));
+        if (shift == 0) return;
+        h.originX = originX;
+        
+        // Move each row's values by whole cells, clearing the columns that come into view
+        const int rowLen = HM_COLS + 1;
+        for (int row = 0; row <= HM_ROWS; ++row) {
+            float* r = &h.density[row * rowLen];
+            if (shift >= rowLen || shift <= -rowLen) {
+                std::fill(r, r + rowLen, 0.0f);
+            } else if (shift > 0) {
+                std::copy(r + shift, r + rowLen, r);
+                std::fill(r + rowLen - shift, r + rowLen, 0.0f);
+            } else {
+                std::copy_backward(r, r + rowLen + shift, r + rowLen);
+                std::fill(r, r - shift, 0.0f);
+            }
+        }
+    }
+    
+    void decayHeatmap(Heatmap& h, long long ticks) {
+        float decay = (ticks == 1) ? HM_DECAY : powf(HM_DECAY, float(ticks));
+        float peak = 0.0f;
+        for (float& d : h.density) {
+            d *= decay;
+            if (d > peak) peak = d;
+        }
+        h.peak = std::max(peak, HM_MIN_PEAK);
+    }
+    
+    void addHeat(Heatmap& h, float x, float y, float weight) {
+        // Bilinear splat onto the 4 surrounding grid vertices
+        float fx = (x - h.originX) / HM_CELL;
+        float fy = (y - HM_Y0) / HM_CELL;
+        if (fx < 0.0f || fy < 0.0f || fx >= HM_COLS || fy >= HM_ROWS) return;
+        
+        int col = int(fx), row = int(fy);
+        float tx = fx - col, ty = fy - row;
+        int v = row * (HM_COLS + 1) + col;
+        h.density[v] += weight * (1 - tx) * (1 - ty);
+        h.density[v + 1] += weight * tx * (1 - ty);
+        h.density[v + HM_COLS + 1] += weight * (1 - tx) * ty;
+        h.density[v + HM_COLS + 2] += weight * tx * ty;
+    }
+    
+    // Draw population heatmap (to be called in World Space context but from Scene)
+    void drawHeatmap(const Heatmap& h) {
+        if (h.density.size() != size_t(HM_VERTS)) return;
+        if (hmPositions.empty()) buildHeatmapGrid();
+        
+        // Color ramp: transparent -> red -> yellow at the running peak
+        float invPeak = 1.0f / h.peak;
+        for (int v = 0; v < HM_VERTS; ++v) {
+            float t = std::min(1.0f, h.density[v] * invPeak);
+            GLfloat* C = &hmColors[v * 4];
+            C[0] = 1.0f;
+            C[1] = (t > 0.5f) ? (t - 0.5f) * 2.0f : 0.0f;
+            C[2] = 0.0f;
+            C[3] = std::min(1.0f, t * 2.0f) * 0.5f;
+        }
+        
+        glPushAttrib(GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+        glPushMatrix();
+        glTranslatef(h.originX - HM_X0, 0.0f, 0.0f); // The grid is built at HM_X0
+        
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive Glow
+        
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, 0, hmPositions.data());
+        glColorPointer(4, GL_FLOAT, 0, hmColors.data());
+        glDrawElements(GL_TRIANGLES, GLsizei(hmIndices.size()), GL_UNSIGNED_INT, hmIndices.data());
+        
+        glPopMatrix();
+        glPopClientAttrib();
+        glPopAttrib();
     }
     
     void toggle(Metrics& m) {
@@ -1,25 +1,108 @@
 #ifndef ANALYTICS_H
 #define ANALYTICS_H
 
+#include <cstdio>
 #include <string>
 #include <vector>
+#include "Memory.h"
+#include "Telemetry.h"
 
 namespace Analytics {
+    // Log-bucketed latency histogram (HDR style: 32 sub-buckets per power of two,
+    // ~1.5% resolution from 1us to 16s). Keeps a sliding window of the most
+    // recent samples next to lifetime counts.
+    const int HIST_SUB_BITS = 5;
+    const int HIST_SUB_BUCKETS = 1 << HIST_SUB_BITS;
+    const int HIST_BUCKETS = 25 * HIST_SUB_BUCKETS;
+    const int HIST_WINDOW = 600; // ~10s at 60Hz
+    
+    struct Histogram {
+        unsigned window[HIST_BUCKETS];
+        unsigned lifetime[HIST_BUCKETS];
+        unsigned recent[HIST_WINDOW]; // Window samples (us), ring
+        int recentHead;
+        int recentCount;
+        unsigned lifetimeMax;
+        unsigned long long lifetimeCount;
+    };
+    
+    struct Percentiles {
+        float p50, p95, p99, max; // Milliseconds
+    };
+    
+    struct Population {
+        int villagers;
+        int animals;
+        int houses;
+        int emitters;
+    };
+    
     struct Metrics {
         float fps;
         float frameTime;
-        int entityCount;
+        float tickTime; // Last Scene::tick (ms)
+        int entityCount; // Villagers + animals
         int particleCount;
-        float memoryUsage; // Estimated or tracked simulated
+        Population population;
+        float memoryUsage; // Tracked container bytes (MB), see MemoryTracker
+        float memoryPeak;  // MB
+        float processRSS;  // MB
+        
+        // GL submission, last displayed frame
+        int glBatches;
+        int glVertices;
+        int glStateChanges;
+        int glRedundant;
+        
+        // Chunk streaming (all zero while the whole world is live), see WorldStream
+        int chunksLive;
+        int chunksStored;
+        int chunksUnvisited;
+        
+        Histogram frameTimes; // Interval between ticks
+        Histogram tickTimes;  // Cost of Scene::update
         
         bool active;
         bool showHeatmap;
+        bool showProfiler;
+    };
+    
+    // Population density over the world, binned per tick with exponential decay
+    // so the overlay shows where activity has been concentrated over time
+    struct Heatmap {
+        MemoryTracker::Vector<float, MemoryTracker::ANALYTICS> density; // One value per grid vertex
+        float peak; // Running maximum, used to normalize the color ramp
+        float originX; // World x of the grid's left edge; follows the camera in whole cells
     };
     
     void init(Metrics& m);
-    void update(Metrics& m, int entCount, int partCount);
+    void update(Metrics& m, const Population& pop, int partCount);
+    void recordTick(Metrics& m, long long tickNs);
+    
+    // Completes r (world fields filled by the caller) with the metrics and the
+    // last frame's stage timings, then publishes it (no-op unless Telemetry is open)
+    void publishTelemetry(const Metrics& m, Telemetry::Record& r);
+    
+    // Histograms
+    void resetHistogram(Histogram& h);
+    void addSample(Histogram& h, long long ns);
+    Percentiles windowPercentiles(const Histogram& h);
+    Percentiles lifetimePercentiles(const Histogram& h);
+    void dumpHistograms(const Metrics& m, FILE* out);
+
     void draw(const Metrics& m, int width, int height);
-    void drawHeatmap(const std::vector<float>& entityX, const std::vector<float>& entityY);
+    void drawProfiler(int width, int top); // Stage bars: min/avg/max ms
+    void drawMemory(int width, int top); // Live/peak bytes and allocs per subsystem
+    void drawGLStats(int width, int top); // Batches/vertices/state changes per section
+    
+    // Heatmap: follow the camera and decay once per tick, then add each entity position.
+    // offsetX slides the grid along x (CameraSystem::backdropOffset); history
+    // scrolled off the grid is dropped
+    void initHeatmap(Heatmap& h);
+    void followHeatmap(Heatmap& h, float offsetX);
+    void decayHeatmap(Heatmap& h, long long ticks = 1); // ticks > 1: that many decays at once
+    void addHeat(Heatmap& h, float x, float y, float weight = 1.0f);
+    void drawHeatmap(const Heatmap& h); // World space, one draw call
     void toggle(Metrics& m);
 }
 
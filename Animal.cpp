@@ -2,6 +2,8 @@
 #include <GL/glut.h>
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
+#include "Dormancy.h"
 #include "Style.h"
 
 namespace AnimalSystem {
@@ -13,17 +15,20 @@ namespace AnimalSystem {
         a.targetX = x;
         a.targetY = y;
         a.speed = (type == AnimalType::BIRD) ? Utils::random(0.3f, 0.6f) : Utils::random(0.02f, 0.05f);
-        a.direction = (rand() % 2 == 0) ? 1 : -1;
+        a.direction = (Utils::randomInt(2) == 0) ? 1 : -1;
         a.currentState = (type == AnimalType::BIRD) ? AnimalState::FLYING : AnimalState::IDLE;
         a.stateTimer = Utils::random(2.0f, 5.0f);
         a.animFrame = 0.0f;
         a.herdId = 0;
+        a.homeMin = -20.0f;
+        a.homeMax = (type == AnimalType::BIRD) ? 100.0f : 80.0f;
         return a;
     }
 
-    void update(Animal& a, float time, bool isNight, float windSway) {
-        a.stateTimer -= 0.1f;
-        a.animFrame += 0.1f;
+    void update(Animal& a, float time, bool isNight, float windSway, int ticks) {
+        float n = float(ticks);
+        a.stateTimer -= 0.1f * n;
+        a.animFrame += 0.1f * n;
 
         if (a.type == AnimalType::BIRD) {
             // Bird Logic
@@ -34,17 +39,22 @@ namespace AnimalSystem {
                  a.stateTimer = Utils::random(2.0f, 5.0f);
             }
             // Move
-            a.x += a.speed * a.direction;
+            a.x += a.speed * a.direction * n;
             // Wind handling?
-            a.x += windSway * 0.1f; // Blown by wind
+            a.x += windSway * 0.1f * n; // Blown by wind
             
-            // Loop screen
-            if (a.x > 100) a.x = -20;
-            if (a.x < -20) a.x = 100;
+            // Loop around the home range (a long step keeps its overshoot)
+            float span = a.homeMax - a.homeMin;
+            if (ticks > 1 && span > 0 && (a.x > a.homeMax || a.x < a.homeMin)) {
+                a.x = a.homeMin + fmodf(fmodf(a.x - a.homeMin, span) + span, span);
+            }
+            if (a.x > a.homeMax) a.x = a.homeMin;
+            if (a.x < a.homeMin) a.x = a.homeMax;
             
-            // Y movement
+            // Y movement (easing 5% of the way per tick)
             float dy = a.targetY - a.y;
-            a.y += dy * 0.05f + sin(time * 0.5f) * 0.1f;
+            float ease = (ticks == 1) ? 0.05f : 1.0f - powf(0.95f, n);
+            a.y += dy * ease + sin(time * 0.5f) * 0.1f * n;
             
         } else {
             // Ground Animal Logic
@@ -57,8 +67,11 @@ namespace AnimalSystem {
             }
 
             if (a.stateTimer <= 0 && !isNight) {
+                // A long step can run past the end (though not past a night's sleep)
+                float late = (ticks > 1) ? 0.1f * std::min(std::floor(-a.stateTimer / 0.1f), n - 1.0f) : 0.0f;
+                
                 // Pick new state
-                int r = rand() % 100;
+                int r = Utils::randomInt(100);
                 if (r < 40) { // Grazing
                     a.currentState = AnimalState::GRAZING;
                     a.stateTimer = Utils::random(3.0f, 8.0f);
@@ -72,6 +85,7 @@ namespace AnimalSystem {
                     a.currentState = AnimalState::IDLE;
                     a.stateTimer = Utils::random(2.0f, 5.0f);
                 }
+                a.stateTimer -= late;
             }
             
             if (a.currentState == AnimalState::MOVING) {
@@ -80,23 +94,134 @@ namespace AnimalSystem {
                     a.currentState = AnimalState::IDLE;
                 } else {
                     a.direction = (dx > 0) ? 1 : -1;
-                    a.x += a.speed * a.direction;
-                    a.animFrame += 0.2f;
+                    float stepX = a.speed * a.direction * n;
+                    if (std::abs(stepX) > std::abs(dx)) stepX = dx; // A long step stops at the target
+                    a.x += stepX;
+                    a.animFrame += 0.2f * n;
                 }
                 // Keep boundaries
-                if (a.x < -20) a.x = -20; if (a.x > 80) a.x = 80;
+                if (a.x < a.homeMin) a.x = a.homeMin;
+                if (a.x > a.homeMax) a.x = a.homeMax;
             }
         }
     }
 
-    void draw(const Animal& a, const Utils::Color& ambientLight) {
-        float x = a.x;
-        float y = a.y;
+    namespace {
+        // The sleepers as of the given tick
+        void wakeUpTo(AnimalList& animals, Dormancy::Animals& dormant, long long tick, bool dawn) {
+            if (dormant.asleepSince < 0) return;
+            long long slept = tick - dormant.asleepSince;
+            for (auto& a : animals) {
+                if (a.currentState != AnimalState::SLEEPING) continue;
+                if (dawn && a.stateTimer < 0.1f * float(slept) - 10.0f) {
+                    // Long overdue: replaced on the next update, it only has to stay overdue
+                    a.stateTimer -= 0.1f * float(slept);
+                    a.animFrame = Utils::addRepeated(a.animFrame, 0.1f, slept);
+                    continue;
+                }
+                sleep(a, slept);
+            }
+            dormant.asleepSince = -1;
+            dormant.awake.clear();
+        }
+    }
+    
+    void updateAll(AnimalList& animals, float time, bool isNight, float windSway, const Lod::Frame* lod, Dormancy::Animals* dormant) {
+        if (dormant) {
+            dormant->tick++;
+            if (dormant->asleepSince >= 0 && isNight) {
+                // Asleep: only the rest (animals still up when the lists were made drop out once they sleep)
+                size_t kept = 0;
+                for (int i : dormant->awake) {
+                    Animal& a = animals[i];
+                    int ticks = lod ? Lod::ticksFor(*lod, a.x, size_t(i)) : 1;
+                    if (ticks) update(a, time, isNight, windSway, ticks);
+                    if (a.currentState != AnimalState::SLEEPING) dormant->awake[kept++] = i;
+                }
+                dormant->awake.resize(kept);
+                return;
+            }
+            if (dormant->asleepSince >= 0) wakeUpTo(animals, *dormant, dormant->tick - 1, true); // Dawn, everyone takes this tick
+        }
+        
+        for (size_t i = 0; i < animals.size(); ++i) {
+            int ticks = lod ? Lod::ticksFor(*lod, animals[i].x, i) : 1;
+            if (ticks) update(animals[i], time, isNight, windSway, ticks);
+        }
+        
+        // Nightfall: the sleepers are left alone from here on
+        if (dormant && isNight) {
+            dormant->asleepSince = dormant->tick;
+            dormant->awake.clear();
+            for (size_t i = 0; i < animals.size(); ++i) {
+                if (animals[i].currentState != AnimalState::SLEEPING) dormant->awake.push_back(int(i));
+            }
+        }
+    }
+    
+    void sleep(Animal& a, long long ticks) {
+        // update() at night only runs the clocks
+        a.stateTimer = Utils::addRepeated(a.stateTimer, -0.1f, ticks);
+        a.animFrame = Utils::addRepeated(a.animFrame, 0.1f, ticks);
+    }
+    
+    void wakeAll(AnimalList& animals, Dormancy::Animals& dormant) {
+        wakeUpTo(animals, dormant, dormant.tick, false);
+    }
+
+    void resample(Animal& a, bool isNight) {
+        if (a.type == AnimalType::BIRD) {
+            // Anywhere along the loop, settled at its height
+            a.x = Utils::random(a.homeMin, a.homeMax);
+            a.targetY = Utils::random(30.0f, 60.0f);
+            a.y = a.targetY;
+            a.stateTimer = Utils::random(0.0f, Utils::random(2.0f, 5.0f));
+            return;
+        }
+        
+        // Ground animals wander their whole range over time
+        a.x = Utils::random(a.homeMin, a.homeMax);
+        if (isNight) {
+            a.currentState = AnimalState::SLEEPING;
+            a.stateTimer = 0.0f; // Long run out: picks something new at dawn
+            return;
+        }
         
+        // 1. A stretch drawn by how long it lasts (timer units, a tick is 0.1):
+        //    grazing 3-8, a walk of 10 (idle once there), idle 2-5
+        AnimalState state;
+        float length;
+        do {
+            int r = Utils::randomInt(100);
+            if (r < 40) { state = AnimalState::GRAZING; length = Utils::random(3.0f, 8.0f); }
+            else if (r < 70) { state = AnimalState::MOVING; length = 10.0f; }
+            else { state = AnimalState::IDLE; length = Utils::random(2.0f, 5.0f); }
+        } while (Utils::random(0.0f, 10.0f) >= length);
+        
+        // 2. A moment inside it
+        float into = Utils::random(0.0f, length);
+        a.currentState = state;
+        a.stateTimer = length - into;
+        if (state == AnimalState::MOVING) {
+            a.targetX = a.x + Utils::random(-15.0f, 15.0f) * float(a.direction);
+            float dx = a.targetX - a.x;
+            float moved = std::min(std::abs(dx), a.speed * (into / 0.1f));
+            a.direction = (dx > 0) ? 1 : -1;
+            a.x = std::max(a.homeMin, std::min(a.homeMax, a.x + float(a.direction) * moved));
+            if (std::abs(a.targetX - a.x) < 0.5f) a.currentState = AnimalState::IDLE;
+        }
+    }
+    
+    void queueShadow(const Animal& a) {
         // Shadow (Soft Shadow)
         if (a.type != AnimalType::BIRD) {
-            Style::drawSoftShadow(x, y, 1.5f, 0.3f);
+            Style::queueSoftShadow(a.x, a.y, 1.5f, 0.3f);
         }
+    }
+
+    void draw(const Animal& a, const Utils::Color& ambientLight) {
+        float x = a.x;
+        float y = a.y;
         
         // Base Atmosphere
         Utils::Color tint = ambientLight;
@@ -2,8 +2,12 @@
 #define ANIMAL_H
 
 #include "Utils.h"
+#include "Memory.h"
+#include "Lod.h"
 #include <vector>
 
+namespace Dormancy { struct Animals; }
+
 enum class AnimalType {
     COW,
     SHEEP,
@@ -33,11 +37,30 @@ struct Animal {
     
     // Bounding / Herd
     int herdId;
+    float homeMin, homeMax; // Ground animals are kept inside, birds wrap around
 };
 
+typedef MemoryTracker::Vector<Animal, MemoryTracker::ANIMALS> AnimalList;
+
 namespace AnimalSystem {
     Animal create(AnimalType type, float x, float y);
-    void update(Animal& a, float time, bool isNight, float windSway); // Wind affects bird flight
+    // Wind affects bird flight; ticks > 1 advances that many ticks in one go (Lod tiers)
+    void update(Animal& a, float time, bool isNight, float windSway, int ticks = 1);
+    // update() for every animal (Lod::ticksFor ticks each with lod); with
+    // dormant, the ground animals are left asleep from nightfall to dawn
+    void updateAll(AnimalList& animals, float time, bool isNight, float windSway, const Lod::Frame* lod = nullptr,
+                   Dormancy::Animals* dormant = nullptr);
+    
+    // What ticks asleep do to a ground animal (all at once)
+    void sleep(Animal& a, long long ticks);
+    // Brings the sleepers up to date and drops the lists
+    void wakeAll(AnimalList& animals, Dormancy::Animals& dormant);
+    // The animal at a random moment of its routine, long after now (what a
+    // fast forward leaves): asleep at night, else state and timer drawn from
+    // the mix the rules settle into
+    void resample(Animal& a, bool isNight);
+    // Queue the ground shadow for the batched shadow pass (birds cast none)
+    void queueShadow(const Animal& a);
     void draw(const Animal& a, const Utils::Color& ambientLight);
 }
 
@@ -0,0 +1,260 @@
+#include "Batch.h"
+#include "Scene.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace Batch {
+
+    namespace {
+        const char* WEATHER_NAMES[4] = { "clear", "rain", "snow", "storm" };
+        const char* EVENT_NAMES[4] = { "market_day", "festival", "fireflies", "bird_congregation" }; // EventType minus NONE
+        const char* ANIMAL_NAMES[3] = { "cow", "sheep", "bird" };
+        const char* ANIMAL_STATE_NAMES[5] = { "idle", "grazing", "moving", "sleeping", "flying" };
+        const char* ACTIVITY_NAMES[4] = { "idle", "walking", "working", "socializing" };
+
+        // One value per run for each of these
+        enum Metric {
+            WEATHER_SHARE = 0,                                // 4: fraction of ticks in each weather type
+            EVENT_STARTS_PER_DAY = WEATHER_SHARE + 4,         // 4
+            EVENT_SHARE = EVENT_STARTS_PER_DAY + 4,           // 4: fraction of ticks the event was running
+            CONVERSATIONS = EVENT_SHARE + 4,                  // Villagers starting to socialize
+            CONVERSATIONS_PER_VILLAGER_DAY = CONVERSATIONS + 1,
+            ACTIVITY_SHARE = CONVERSATIONS_PER_VILLAGER_DAY + 1, // 4: fraction of villager-ticks in each activity
+            ANIMAL_SHARE = ACTIVITY_SHARE + 4,                // 3 x 5: fraction of a type's animal-ticks in each state
+            METRIC_COUNT = ANIMAL_SHARE + 3 * 5
+        };
+
+        struct Options {
+            int runs;
+            int days;
+            unsigned seed; // Run i uses seed + i
+            int threads;   // 0 = one per core
+            Scene::WorldConfig world;
+            const char* outPath;
+            bool json;
+            bool lod; // Off-screen entities at reduced detail, as in the interactive view
+
+            Options() : runs(1000), days(7), seed(1), threads(0), outPath(nullptr), json(false), lod(false) {}
+        };
+
+        // Streaming mean/variance (Welford), mergeable across workers (Chan et al.)
+        struct Accumulator {
+            long long n;
+            double mean;
+            double m2;
+            double min, max;
+        };
+
+        void addValue(Accumulator& a, double x) {
+            if (std::isnan(x)) return; // Metric does not apply to this run (no birds, no villagers)
+            a.n++;
+            double d = x - a.mean;
+            a.mean += d / a.n;
+            a.m2 += d * (x - a.mean);
+            if (a.n == 1 || x < a.min) a.min = x;
+            if (a.n == 1 || x > a.max) a.max = x;
+        }
+
+        void merge(Accumulator& a, const Accumulator& b) {
+            if (b.n == 0) return;
+            if (a.n == 0) { a = b; return; }
+            long long n = a.n + b.n;
+            double d = b.mean - a.mean;
+            a.mean += d * b.n / n;
+            a.m2 += b.m2 + d * d * (double(a.n) * b.n / n);
+            a.min = std::min(a.min, b.min);
+            a.max = std::max(a.max, b.max);
+            a.n = n;
+        }
+
+        double stddev(const Accumulator& a) {
+            return a.n > 1 ? std::sqrt(a.m2 / (a.n - 1)) : 0.0;
+        }
+
+        void metricName(int m, char* out, size_t size) {
+            if (m < EVENT_STARTS_PER_DAY) snprintf(out, size, "weather.%s.share", WEATHER_NAMES[m - WEATHER_SHARE]);
+            else if (m < EVENT_SHARE) snprintf(out, size, "event.%s.starts_per_day", EVENT_NAMES[m - EVENT_STARTS_PER_DAY]);
+            else if (m < CONVERSATIONS) snprintf(out, size, "event.%s.share", EVENT_NAMES[m - EVENT_SHARE]);
+            else if (m == CONVERSATIONS) snprintf(out, size, "social.conversations");
+            else if (m == CONVERSATIONS_PER_VILLAGER_DAY) snprintf(out, size, "social.conversations_per_villager_day");
+            else if (m < ANIMAL_SHARE) snprintf(out, size, "villager.%s.share", ACTIVITY_NAMES[m - ACTIVITY_SHARE]);
+            else snprintf(out, size, "animal.%s.%s.share", ANIMAL_NAMES[(m - ANIMAL_SHARE) / 5], ANIMAL_STATE_NAMES[(m - ANIMAL_SHARE) % 5]);
+        }
+
+        // One village from its seed; observed after every tick, nothing kept but the per-run values
+        void simulate(unsigned seed, int ticks, const Options& opt, Scene::State& state, std::vector<Activity>& prev, double values[METRIC_COUNT]) {
+            Utils::seedRandom(seed);
+            Scene::buildWorld(state, opt.world);
+            state.lod = opt.lod;
+
+            long long weatherTicks[4] = {};
+            long long eventStarts[5] = {};
+            long long eventTicks[5] = {};
+            long long conversations = 0;
+            long long activityTicks[4] = {};
+            long long animalTicks[3][5] = {};
+            bool wasActive = false;
+            EventType lastEvent = EventType::NONE;
+
+            prev.assign(state.villagers.size(), Activity::IDLE);
+            for (size_t i = 0; i < state.villagers.size(); i++) prev[i] = state.villagers[i].currentActivity;
+
+            for (int t = 0; t < ticks; t++) {
+                Scene::step(state);
+
+                weatherTicks[int(state.weather.currentType) & 3]++;
+
+                if (state.events.isActive) {
+                    int e = int(state.events.currentEvent);
+                    if (!wasActive || state.events.currentEvent != lastEvent) eventStarts[e]++;
+                    eventTicks[e]++;
+                }
+                wasActive = state.events.isActive;
+                lastEvent = state.events.currentEvent;
+
+                // A conversation starts when a villager switches into SOCIALIZING
+                for (size_t i = 0; i < state.villagers.size(); i++) {
+                    Activity a = state.villagers[i].currentActivity;
+                    if (a == Activity::SOCIALIZING && prev[i] != Activity::SOCIALIZING) conversations++;
+                    prev[i] = a;
+                    activityTicks[int(a)]++;
+                }
+
+                for (const auto& a : state.animals) animalTicks[int(a.type)][int(a.currentState)]++;
+            }
+
+            const double NONE = std::nan("");
+            for (int w = 0; w < 4; w++) values[WEATHER_SHARE + w] = double(weatherTicks[w]) / ticks;
+            for (int e = 0; e < 4; e++) {
+                values[EVENT_STARTS_PER_DAY + e] = double(eventStarts[e + 1]) / opt.days;
+                values[EVENT_SHARE + e] = double(eventTicks[e + 1]) / ticks;
+            }
+            values[CONVERSATIONS] = double(conversations);
+            values[CONVERSATIONS_PER_VILLAGER_DAY] = state.villagers.empty() ? NONE : double(conversations) / state.villagers.size() / opt.days;
+            long long villagerTicks = (long long)state.villagers.size() * ticks;
+            for (int a = 0; a < 4; a++) values[ACTIVITY_SHARE + a] = villagerTicks ? double(activityTicks[a]) / villagerTicks : NONE;
+            for (int type = 0; type < 3; type++) {
+                long long total = 0;
+                for (int s = 0; s < 5; s++) total += animalTicks[type][s];
+                for (int s = 0; s < 5; s++) values[ANIMAL_SHARE + type * 5 + s] = total ? double(animalTicks[type][s]) / total : NONE;
+            }
+        }
+
+        void writeCsv(FILE* out, const Accumulator* acc) {
+            fprintf(out, "metric,runs,mean,stddev,min,max\n");
+            for (int m = 0; m < METRIC_COUNT; m++) {
+                char name[64];
+                metricName(m, name, sizeof(name));
+                fprintf(out, "%s,%lld,%.6g,%.6g,%.6g,%.6g\n", name, acc[m].n, acc[m].mean, stddev(acc[m]), acc[m].min, acc[m].max);
+            }
+        }
+
+        void writeJson(FILE* out, const Options& opt, int ticksPerDay, const Accumulator* acc) {
+            fprintf(out, "{\n  \"runs\": %d,\n  \"days\": %d,\n  \"ticksPerDay\": %d,\n  \"seed\": %u,\n", opt.runs, opt.days, ticksPerDay, opt.seed);
+            fprintf(out, "  \"world\": {\"villagers\":%d,\"animals\":%d,\"houses\":%d,\"particlePool\":%d,\"emitters\":%d,\"lod\":%s},\n  \"metrics\": {",
+                    opt.world.villagers, opt.world.animals, opt.world.houses, opt.world.particlePool, opt.world.emitters, opt.lod ? "true" : "false");
+            for (int m = 0; m < METRIC_COUNT; m++) {
+                char name[64];
+                metricName(m, name, sizeof(name));
+                fprintf(out, "%s\n    \"%s\": {\"runs\":%lld,\"mean\":%.6g,\"stddev\":%.6g,\"min\":%.6g,\"max\":%.6g}",
+                        m ? "," : "", name, acc[m].n, acc[m].mean, stddev(acc[m]), acc[m].min, acc[m].max);
+            }
+            fprintf(out, "\n  }\n}\n");
+        }
+    }
+
+    int run(int argc, char** argv) {
+        Options opt;
+        
+        // --scene first: it sets the world, the size options then adjust it
+        static SceneFile::Layout layout;
+        for (int i = 1; i + 1 < argc; i++) {
+            if (strcmp(argv[i], "--scene") != 0) continue;
+            if (!SceneFile::load(argv[i + 1], layout)) return 1;
+            opt.world = Scene::WorldConfig(layout);
+        }
+        
+        for (int i = 1; i < argc; i++) {
+            bool more = i + 1 < argc;
+            if (strcmp(argv[i], "--runs") == 0 && more) opt.runs = std::max(1, atoi(argv[++i]));
+            else if (strcmp(argv[i], "--days") == 0 && more) opt.days = std::max(1, atoi(argv[++i]));
+            else if (strcmp(argv[i], "--seed") == 0 && more) opt.seed = unsigned(strtoul(argv[++i], nullptr, 10));
+            else if (strcmp(argv[i], "--threads") == 0 && more) opt.threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--villagers") == 0 && more) opt.world.villagers = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--animals") == 0 && more) opt.world.animals = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--houses") == 0 && more) opt.world.houses = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--emitters") == 0 && more) opt.world.emitters = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--particles") == 0 && more) opt.world.particlePool = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--out") == 0 && more) opt.outPath = argv[++i];
+            else if (strcmp(argv[i], "--json") == 0) opt.json = true;
+            else if (strcmp(argv[i], "--lod") == 0) opt.lod = true;
+        }
+        if (opt.outPath) {
+            size_t len = strlen(opt.outPath);
+            if (len > 5 && strcmp(opt.outPath + len - 5, ".json") == 0) opt.json = true;
+        }
+
+        int threads = opt.threads > 0 ? opt.threads : int(std::max(1u, std::thread::hardware_concurrency()));
+        threads = std::min(threads, opt.runs);
+        int ticksPerDay = int(24.0f / Scene::State().timeSpeed + 0.5f);
+        int ticks = ticksPerDay * opt.days;
+
+        // 1. Workers pull run indices and fold each run into their own accumulators
+        std::vector<std::vector<Accumulator>> perWorker(threads, std::vector<Accumulator>(METRIC_COUNT, Accumulator()));
+        std::atomic<int> next(0);
+        std::atomic<int> done(0);
+        auto worker = [&](int w) {
+            Scene::State state;
+            std::vector<Activity> prev;
+            double values[METRIC_COUNT];
+            for (int r = next.fetch_add(1); r < opt.runs; r = next.fetch_add(1)) {
+                simulate(opt.seed + unsigned(r), ticks, opt, state, prev, values);
+                for (int m = 0; m < METRIC_COUNT; m++) addValue(perWorker[w][m], values[m]);
+                done.fetch_add(1);
+            }
+        };
+
+        long long startNs = Profiler::nowNs();
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; t++) pool.emplace_back(worker, t);
+
+        // 2. Progress on stderr while they run
+        int reported = 0;
+        while (reported < opt.runs) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            int d = done.load();
+            if (d != reported) {
+                reported = d;
+                double elapsed = (Profiler::nowNs() - startNs) * 1e-9;
+                fprintf(stderr, "\rbatch: %d/%d runs (%.0f runs/s)", d, opt.runs, elapsed > 0 ? d / elapsed : 0.0);
+            }
+        }
+        for (auto& t : pool) t.join();
+        double seconds = (Profiler::nowNs() - startNs) * 1e-9;
+        fprintf(stderr, "\rbatch: %d runs x %d days (%d ticks) on %d threads in %.1f s\n", opt.runs, opt.days, ticks, threads, seconds);
+
+        // 3. Merge and write the summary
+        std::vector<Accumulator> total(METRIC_COUNT, Accumulator());
+        for (const auto& acc : perWorker) {
+            for (int m = 0; m < METRIC_COUNT; m++) merge(total[m], acc[m]);
+        }
+
+        FILE* out = opt.outPath ? fopen(opt.outPath, "w") : stdout;
+        if (!out) {
+            fprintf(stderr, "batch: cannot write %s\n", opt.outPath);
+            return 1;
+        }
+        if (opt.json) writeJson(out, opt, ticksPerDay, total.data());
+        else writeCsv(out, total.data());
+        if (out != stdout) fclose(out);
+        return 0;
+    }
+}
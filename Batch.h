@@ -0,0 +1,15 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+// Monte Carlo batch runs (village.exe --batch ...).
+// Runs many seeded headless villages on every core, each for a fixed number
+// of simulated days, and folds what happened in each run (weather time shares,
+// event starts, villager conversations, animal state occupancy) into running
+// mean/stddev/min/max accumulators. Only the summary is written (CSV or JSON);
+// individual runs are never stored.
+namespace Batch {
+    // Returns the process exit code
+    int run(int argc, char** argv);
+}
+
+#endif // BATCH_H
@@ -0,0 +1,292 @@
+#include "Benchmark.h"
+#include "Scene.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Benchmark {
+
+    namespace {
+        const char* SEASON_NAMES[4] = { "spring", "summer", "autumn", "winter" };
+        const char* WEATHER_NAMES[4] = { "clear", "rain", "snow", "storm" };
+
+        struct Options {
+            int ticks;
+            int warmup;
+            unsigned seed;
+            // World sizes are swept in lockstep: step i uses entry i of every list
+            // (a shorter list repeats its last entry)
+            std::vector<int> villagers;
+            std::vector<int> animals;
+            std::vector<int> houses;
+            std::vector<int> particles;
+            std::vector<int> emitters;
+            std::vector<int> seasons;  // Utils::Season values
+            std::vector<int> weathers; // WeatherType values
+            const char* outPath;
+            const char* baselinePath;
+            float threshold; // Fractional slowdown that counts as a regression
+
+            Options() : ticks(600), warmup(60), seed(12345),
+                villagers{10, 100, 1000}, animals{10, 100, 1000}, houses{3, 30, 300}, particles{500, 5000, 50000}, emitters{0},
+                seasons{0, 1, 2, 3}, weathers{0, 1, 2, 3},
+                outPath(nullptr), baselinePath(nullptr), threshold(0.10f) {}
+        };
+
+        struct StageTime {
+            const char* name;
+            int depth;
+            double msPerTick;
+        };
+
+        struct Result {
+            std::string scenario;
+            Scene::WorldConfig world;
+            int season;
+            int weather;
+            double seconds;
+            double ticksPerSec;
+            double nsPerEntity; // Per entity per tick
+            int liveParticles;
+            std::vector<StageTime> stages;
+        };
+
+        std::vector<int> parseInts(const char* s) {
+            std::vector<int> out;
+            while (*s) {
+                char* end;
+                long v = strtol(s, &end, 10);
+                if (end == s) break;
+                out.push_back(int(v));
+                s = (*end == ',') ? end + 1 : end;
+            }
+            return out;
+        }
+
+        // "all" or a comma list of names
+        std::vector<int> parseNames(const char* s, const char* const names[4]) {
+            std::vector<int> out;
+            if (strcmp(s, "all") == 0) return std::vector<int>{0, 1, 2, 3};
+            std::string list(s);
+            size_t pos = 0;
+            while (pos <= list.size()) {
+                size_t comma = list.find(',', pos);
+                if (comma == std::string::npos) comma = list.size();
+                std::string item = list.substr(pos, comma - pos);
+                for (int i = 0; i < 4; i++) {
+                    if (item == names[i]) out.push_back(i);
+                }
+                pos = comma + 1;
+            }
+            return out;
+        }
+
+        void printUsage() {
+            fprintf(stderr,
+                "usage: --bench [--ticks N] [--warmup N] [--seed N]\n"
+                "               [--villagers a,b,..] [--animals a,b,..] [--houses a,b,..] [--particles a,b,..] [--emitters a,b,..]\n"
+                "               [--seasons all|spring,summer,autumn,winter] [--weather all|clear,rain,snow,storm]\n"
+                "               [--out results.json] [--baseline old.json] [--threshold 0.10]\n");
+        }
+
+        bool parseOptions(int argc, char** argv, Options& opt) {
+            for (int i = 1; i < argc; i++) {
+                const char* a = argv[i];
+                const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+                if (strcmp(a, "--bench") == 0) continue;
+                if (!v) { printUsage(); return false; }
+
+                if (strcmp(a, "--ticks") == 0) opt.ticks = atoi(v);
+                else if (strcmp(a, "--warmup") == 0) opt.warmup = atoi(v);
+                else if (strcmp(a, "--seed") == 0) opt.seed = unsigned(strtoul(v, nullptr, 10));
+                else if (strcmp(a, "--villagers") == 0) opt.villagers = parseInts(v);
+                else if (strcmp(a, "--animals") == 0) opt.animals = parseInts(v);
+                else if (strcmp(a, "--houses") == 0) opt.houses = parseInts(v);
+                else if (strcmp(a, "--particles") == 0) opt.particles = parseInts(v);
+                else if (strcmp(a, "--emitters") == 0) opt.emitters = parseInts(v);
+                else if (strcmp(a, "--seasons") == 0) opt.seasons = parseNames(v, SEASON_NAMES);
+                else if (strcmp(a, "--weather") == 0) opt.weathers = parseNames(v, WEATHER_NAMES);
+                else if (strcmp(a, "--out") == 0) opt.outPath = v;
+                else if (strcmp(a, "--baseline") == 0) opt.baselinePath = v;
+                else if (strcmp(a, "--threshold") == 0) opt.threshold = float(atof(v));
+                else { printUsage(); return false; }
+                i++;
+            }
+
+            if (opt.ticks <= 0 || opt.villagers.empty() || opt.animals.empty() || opt.houses.empty() ||
+                opt.particles.empty() || opt.emitters.empty() || opt.seasons.empty() || opt.weathers.empty()) {
+                printUsage();
+                return false;
+            }
+            return true;
+        }
+
+        int sweepAt(const std::vector<int>& list, size_t step) {
+            return list[std::min(step, list.size() - 1)];
+        }
+
+        Result runScenario(const Options& opt, const Scene::WorldConfig& world, int season, int weather) {
+            // 1. Same seed for every scenario so sizes are the only difference
+            Utils::seedRandom(opt.seed);
+            Scene::buildWorld(world);
+            Scene::State& state = Scene::getState();
+            state.currentSeason = (Utils::Season)season;
+            WeatherSystem::setWeather(state.weather, (WeatherType)weather);
+            state.weather.holdType = true;
+
+            // 2. Warm up (fills particle pools, settles villagers into their routines)
+            for (int i = 0; i < opt.warmup; i++) {
+                state.seasonTimer = 0.0f; // Keep the season pinned
+                Scene::tick();
+                Profiler::endFrame();
+            }
+
+            // 3. Timed ticks (profiler drain is outside the measured time)
+            Profiler::resetTotals();
+            long long totalNs = 0;
+            for (int i = 0; i < opt.ticks; i++) {
+                state.seasonTimer = 0.0f;
+                long long startNs = Profiler::nowNs();
+                Scene::tick();
+                totalNs += Profiler::nowNs() - startNs;
+                Profiler::endFrame();
+            }
+
+            // 4. Results
+            Result r;
+            char name[128], emitters[16] = "";
+            if (world.emitters > 0) snprintf(emitters, sizeof(emitters), "_e%d", world.emitters);
+            snprintf(name, sizeof(name), "v%d_a%d_h%d_p%d%s/%s/%s", world.villagers, world.animals, world.houses,
+                     world.particlePool, emitters, SEASON_NAMES[season], WEATHER_NAMES[weather]);
+            r.scenario = name;
+            r.world = world;
+            r.season = season;
+            r.weather = weather;
+            r.seconds = totalNs * 1e-9;
+            r.ticksPerSec = (totalNs > 0) ? opt.ticks / r.seconds : 0.0;
+            int entities = std::max(1, world.villagers + world.animals + world.houses);
+            r.nsPerEntity = double(totalNs) / opt.ticks / entities;
+            r.liveParticles = Scene::getState().particles.liveCount;
+
+            std::vector<Profiler::StageStats> stats;
+            Profiler::getStats(stats);
+            for (const auto& s : stats) {
+                if (s.totalMs <= 0.0) continue; // Display stages never run headless
+                StageTime st = { s.name, s.depth, s.totalMs / opt.ticks };
+                r.stages.push_back(st);
+            }
+            return r;
+        }
+
+        void writeJson(FILE* out, const Options& opt, const std::vector<Result>& results) {
+            fprintf(out, "{\n  \"ticks\": %d,\n  \"warmup\": %d,\n  \"seed\": %u,\n  \"scenarios\": [", opt.ticks, opt.warmup, opt.seed);
+            for (size_t i = 0; i < results.size(); i++) {
+                const Result& r = results[i];
+                fprintf(out, "%s\n    {\"scenario\":\"%s\",\"villagers\":%d,\"animals\":%d,\"houses\":%d,\"particlePool\":%d,\"emitters\":%d,",
+                        i ? "," : "", r.scenario.c_str(), r.world.villagers, r.world.animals, r.world.houses, r.world.particlePool, r.world.emitters);
+                fprintf(out, "\"season\":\"%s\",\"weather\":\"%s\",\"seconds\":%.6f,\"ticksPerSec\":%.2f,\"nsPerEntity\":%.2f,\"liveParticles\":%d,",
+                        SEASON_NAMES[r.season], WEATHER_NAMES[r.weather], r.seconds, r.ticksPerSec, r.nsPerEntity, r.liveParticles);
+                fputs("\"subsystems\":[", out);
+                for (size_t j = 0; j < r.stages.size(); j++) {
+                    fprintf(out, "%s{\"name\":\"%s\",\"depth\":%d,\"msPerTick\":%.6f}",
+                            j ? "," : "", r.stages[j].name, r.stages[j].depth, r.stages[j].msPerTick);
+                }
+                fputs("]}", out);
+            }
+            fputs("\n  ]\n}\n", out);
+        }
+
+        // Pulls (scenario, ticksPerSec) pairs out of an earlier results file
+        bool loadBaseline(const char* path, std::vector<std::pair<std::string, double> >& out) {
+            FILE* f = fopen(path, "rb");
+            if (!f) return false;
+            std::string text;
+            char buf[4096];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+            fclose(f);
+
+            const std::string nameKey = "\"scenario\":\"";
+            const std::string tpsKey = "\"ticksPerSec\":";
+            size_t pos = 0;
+            while ((pos = text.find(nameKey, pos)) != std::string::npos) {
+                pos += nameKey.size();
+                size_t end = text.find('"', pos);
+                size_t tps = text.find(tpsKey, end);
+                if (end == std::string::npos || tps == std::string::npos) break;
+                out.push_back(std::make_pair(text.substr(pos, end - pos), strtod(text.c_str() + tps + tpsKey.size(), nullptr)));
+                pos = end;
+            }
+            return true;
+        }
+
+        int compare(const Options& opt, const std::vector<Result>& results) {
+            std::vector<std::pair<std::string, double> > baseline;
+            if (!loadBaseline(opt.baselinePath, baseline)) {
+                fprintf(stderr, "bench: cannot read baseline %s\n", opt.baselinePath);
+                return 1;
+            }
+
+            int regressions = 0;
+            fprintf(stderr, "\n%-40s %12s %12s %8s\n", "scenario", "base t/s", "now t/s", "delta");
+            for (const auto& r : results) {
+                const std::pair<std::string, double>* base = nullptr;
+                for (const auto& b : baseline) {
+                    if (b.first == r.scenario) { base = &b; break; }
+                }
+                if (!base || base->second <= 0.0) {
+                    fprintf(stderr, "%-40s %12s %12.1f %8s\n", r.scenario.c_str(), "-", r.ticksPerSec, "new");
+                    continue;
+                }
+
+                double delta = r.ticksPerSec / base->second - 1.0;
+                bool slower = delta < -opt.threshold;
+                if (slower) regressions++;
+                fprintf(stderr, "%-40s %12.1f %12.1f %+7.1f%%%s\n", r.scenario.c_str(), base->second, r.ticksPerSec,
+                        delta * 100.0, slower ? "  REGRESSION" : "");
+            }
+            fprintf(stderr, "%d regression(s) beyond %.0f%%\n", regressions, opt.threshold * 100.0f);
+            return regressions > 0 ? 1 : 0;
+        }
+    }
+
+    int run(int argc, char** argv) {
+        Options opt;
+        if (!parseOptions(argc, argv, opt)) return 2;
+
+        size_t steps = std::max(std::max(std::max(opt.villagers.size(), opt.animals.size()),
+                                         std::max(opt.houses.size(), opt.particles.size())), opt.emitters.size());
+
+        std::vector<Result> results;
+        for (size_t step = 0; step < steps; step++) {
+            Scene::WorldConfig world;
+            world.villagers = sweepAt(opt.villagers, step);
+            world.animals = sweepAt(opt.animals, step);
+            world.houses = sweepAt(opt.houses, step);
+            world.particlePool = sweepAt(opt.particles, step);
+            world.emitters = sweepAt(opt.emitters, step);
+
+            for (int season : opt.seasons) {
+                for (int weather : opt.weathers) {
+                    results.push_back(runScenario(opt, world, season, weather));
+                    const Result& r = results.back();
+                    fprintf(stderr, "%-40s %10.1f ticks/s %10.1f ns/entity\n", r.scenario.c_str(), r.ticksPerSec, r.nsPerEntity);
+                }
+            }
+        }
+
+        FILE* out = opt.outPath ? fopen(opt.outPath, "w") : stdout;
+        if (!out) {
+            fprintf(stderr, "bench: cannot write %s\n", opt.outPath);
+            return 1;
+        }
+        writeJson(out, opt, results);
+        if (out != stdout) fclose(out);
+
+        return opt.baselinePath ? compare(opt, results) : 0;
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// Headless scenario benchmarks (village.exe --bench ...).
+// Builds worlds of the requested sizes, pins each season/weather combination,
+// runs a fixed number of simulation ticks and writes ticks/sec, ns per entity
+// and the per-subsystem profiler breakdown as JSON. With --baseline the run is
+// compared against an earlier results file and slower scenarios are flagged.
+namespace Benchmark {
+    // Returns the process exit code (1 when a regression was flagged)
+    int run(int argc, char** argv);
+}
+
+#endif // BENCHMARK_H
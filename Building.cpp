@@ -17,28 +17,54 @@ namespace Building {
         p.roofHeight = Utils::random(5.0f, 8.0f);
         
         // Random Colors from Style Palette
-        bool isStone = (rand() % 4 == 0);
+        bool isStone = (Utils::randomInt(4) == 0);
         if (isStone) {
             p.wallColor = Style::Palette::STONE_GRAY;
         } else {
-            p.wallColor = (rand() % 2 == 0) ? Style::Palette::WALL_WOOD_LIGHT : Style::Palette::WALL_WOOD_DARK;
+            p.wallColor = (Utils::randomInt(2) == 0) ? Style::Palette::WALL_WOOD_LIGHT : Style::Palette::WALL_WOOD_DARK;
         }
         
-        p.roofColor = (rand() % 2 == 0) ? Style::Palette::ROOF_RED : Style::Palette::ROOF_THATCH;
+        p.roofColor = (Utils::randomInt(2) == 0) ? Style::Palette::ROOF_RED : Style::Palette::ROOF_THATCH;
         p.doorColor = Utils::Color(0.4f, 0.2f, 0.1f);
         
-        p.hasChimney = (rand() % 2 == 0);
+        p.hasChimney = (Utils::randomInt(2) == 0);
         p.lightOn = false;
         p.doorAngle = 0.0f;
+        p.windowLights[0] = INVALID_LIGHT;
+        p.windowLights[1] = INVALID_LIGHT;
         
         return p;
     }
 
-    void update(BuildingProps& props, float time, bool isNight) {
+    void registerLights(BuildingProps& p, LightRegistry& reg) {
+        // Two warm window lights, on at night
+        LightSource l;
+        l.radius = 8.0f;
+        l.color = Utils::Color(1.0f, 0.9f, 0.4f, 0.8f); // Warm yellow
+        l.flickerOffset = 0.0f;
+        l.active = false;
+        l.nightOnly = true;
+        l.inUse = true;
+        
+        l.x = p.x + 2; l.y = p.y + 6.5f;
+        p.windowLights[0] = LightingSystem::registerLight(reg, l);
+        
+        l.x = p.x + 10;
+        p.windowLights[1] = LightingSystem::registerLight(reg, l);
+    }
+
+    void unregisterLights(BuildingProps& p, LightRegistry& reg) {
+        for (int i = 0; i < 2; i++) {
+            LightingSystem::unregisterLight(reg, p.windowLights[i]);
+            p.windowLights[i] = INVALID_LIGHT;
+        }
+    }
+
+    void update(BuildingProps& props, ParticleState& particles, float time, bool isNight) {
         // Smoke Spawning
         if (props.hasChimney) {
-            if (rand() % 10 < 3) {
-                ParticleSystem::spawnSmoke(props.x + props.width - 3, props.y + props.height + 6);
+            if (Utils::randomInt(10) < 3) {
+                ParticleSystem::spawnSmoke(particles, props.x + props.width - 3, props.y + props.height + 6);
             }
         }
         
@@ -46,7 +72,7 @@ namespace Building {
         // Random flickering for window light
         if (isNight) {
 
-            if (rand() % 100 < 2) props.lightOn = !props.lightOn; // Rare toggle
+            if (Utils::randomInt(100) < 2) props.lightOn = !props.lightOn; // Rare toggle
              // Or just always on with flicker? Let's say mostly on at night.
             props.lightOn = true; 
         } else {
@@ -62,15 +88,30 @@ namespace Building {
         }
     }
 
+    void skip(BuildingProps& props, ParticleState& particles, float time, bool isNight, long long ticks,
+              float windStrength, int width, int height) {
+        if (props.hasChimney) {
+            ParticleSystem::skipSmoke(particles, props.x + props.width - 3, props.y + props.height + 6, 0.3f,
+                                      ticks, windStrength, width, height);
+        }
+        props.lightOn = isNight;
+        
+        // The door eases towards where it is heading now for the whole skip
+        float target = (!isNight && (int(time) % 10 < 3)) ? 1.0f : 0.0f;
+        props.doorAngle = target + (props.doorAngle - target) * powf(0.95f, float(ticks));
+    }
+
+    void queueShadow(const BuildingProps& p) {
+        // Shadow (AO / Soft Shadow)
+        Style::queueSoftShadow(p.x + p.width/2, p.y, p.width * 0.7f, 0.3f);
+    }
+
     void draw(BuildingProps& p, float time, const Utils::Color& ambientLight, Utils::Season season) {
         float x = p.x;
         float y = p.y;
         float w = p.width;
         float h = p.height;
         
-        // Shadow (AO / Soft Shadow)
-        Style::drawSoftShadow(x + w/2, y, w * 0.7f, 0.3f);
-        
         // Walls (Atmospheric)
         Utils::Color wallC = Style::applyAtmosphere(p.wallColor, time, (season == Utils::Season::WINTER?0.2f:0.0f));
         Utils::drawRect(x, y, x + w, y + h, wallC);
@@ -121,13 +162,6 @@ namespace Building {
         }
         
         Utils::drawRect(winX, winY, winX+winSize, winY+winSize, winColor);
-        
-        // Add Bloom/Glow for active light
-        if (p.lightOn) {
-            glEnable(GL_BLEND);
-            glColor4f(1.0f, 0.9f, 0.5f, 0.2f);
-            Utils::drawCircle(winSize * 2.0f, winX + winSize/2, winY + winSize/2, 20, true);
-            glDisable(GL_BLEND);
-        }
+        // Glow for an active light comes from the window light's bloom in the lightmap
     }
 }
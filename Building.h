@@ -3,6 +3,9 @@
 
 #include <cmath>
 #include "Utils.h"
+#include "Lighting.h"
+#include "Particles.h"
+#include "Memory.h"
 
 struct BuildingProps {
     float x, y;
@@ -16,8 +19,13 @@ struct BuildingProps {
     
     // Animation states
     float doorAngle; // 0.0 (closed) to 1.0 (open)
+    
+    // Registered window lights (INVALID_LIGHT until registerLights)
+    LightHandle windowLights[2];
 };
 
+typedef MemoryTracker::Vector<BuildingProps, MemoryTracker::HOUSES> BuildingList;
+
 namespace Building {
     // Generate a building with randomized properties
     BuildingProps create(float x, float y);
@@ -25,8 +33,18 @@ namespace Building {
     // Draw the building with its current state
     void draw(BuildingProps& props, float time, const Utils::Color& ambientLight, Utils::Season season = Utils::Season::SPRING);
     
+    // Register the window lights once; the lighting schedule switches them
+    void registerLights(BuildingProps& props, LightRegistry& reg);
+    void unregisterLights(BuildingProps& props, LightRegistry& reg); // Before removing the building
+    
+    // Queue the ground shadow for the batched shadow pass (Style::flushSoftShadows)
+    void queueShadow(const BuildingProps& props);
+    
     // Update animation states (smoke, door, lights)
-    void update(BuildingProps& props, float time, bool isNight);
+    void update(BuildingProps& props, ParticleState& particles, float time, bool isNight); // Chimney smoke goes into particles
+    // ticks of update() at once, ending at time (the smoke through ParticleSystem::skipSmoke)
+    void skip(BuildingProps& props, ParticleState& particles, float time, bool isNight, long long ticks,
+              float windStrength, int width, int height);
 }
 
 #endif // BUILDING_H
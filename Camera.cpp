@@ -49,6 +49,29 @@ namespace CameraSystem {
          panTo(cam, x, y, zoom);
     }
     
+    void panBy(CameraState& cam, float dx) {
+         cam.isCinematic = false;
+         cam.targetX += dx;
+    }
+    
+    float viewCenterX(const CameraState& cam) {
+        return cam.x + 30.0f; // Middle of the -20..80 projection
+    }
+    
+    void visibleRange(const CameraState& cam, float& minX, float& maxX) {
+        // Inverse of apply(): zoom pivots on x = 40
+        minX = cam.x + 40.0f - 60.0f / cam.zoom;
+        maxX = cam.x + 40.0f + 40.0f / cam.zoom;
+    }
+    
+    float backdropOffset(const CameraState& cam) {
+        // The backdrop is drawn oversized for the cinematic drift around the village
+        const float reach = 40.0f;
+        if (cam.x > reach) return cam.x - reach;
+        if (cam.x < -reach) return cam.x + reach;
+        return 0.0f;
+    }
+    
     void updateCinematic(CameraState& cam, float timeOfDay) {
         if (!cam.isCinematic) return;
         
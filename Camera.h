@@ -24,6 +24,17 @@ namespace CameraSystem {
     // Actions
     void panTo(CameraState& cam, float x, float y, float zoom = 1.0f);
     void jumpTo(CameraState& cam, float x, float y, float zoom = 1.0f);
+    void panBy(CameraState& cam, float dx); // Manual pan, ends the cinematic tour
+    
+    // World x at the middle of the view
+    float viewCenterX(const CameraState& cam);
+    
+    // World x range on screen (the -20..80 projection at the current zoom)
+    void visibleRange(const CameraState& cam, float& minX, float& maxX);
+    
+    // How far the view has panned past what the backdrop (sky, ground, river,
+    // lightmap) covers; those layers are shifted by this to stay in view
+    float backdropOffset(const CameraState& cam);
     
     // Automated Logic hook
     void updateCinematic(CameraState& cam, float timeOfDay);
@@ -1,7 +1,10 @@
 #include "Character.h"
 #include <GL/glut.h>
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <functional>
+#include "Dormancy.h"
 #include "Style.h"
 
 namespace CharacterSystem {
@@ -23,73 +26,437 @@ namespace CharacterSystem {
         c.activityTimer = Utils::random(5.0f, 15.0f); // 5-15 seconds
         
         c.animFrame = 0.0f;
-        c.direction = (rand() % 2 == 0) ? 1 : -1;
+        c.direction = (Utils::randomInt(2) == 0) ? 1 : -1;
         
         c.conversationPartnerId = -1;
+        c.homeMin = -20.0f;
+        c.homeMax = 60.0f;
         
         return c;
     }
 
-    void update(Character& c, float time, const std::vector<Character>& others, int myIndex, float weatherSpeedMod) {
-        c.activityTimer -= 0.1f;
-        if (c.activityTimer <= 0) {
-            // New decision
-            int r = rand() % 100;
-            if (r < 40) {
-                // Walk to new random location
-                c.currentActivity = Activity::WALKING;
-                c.targetX = Utils::random(-20.0f, 60.0f);
-                c.activityTimer = 20.0f; // Give enough time
-            } else if (r < 70) {
-                // Just idle
-                c.currentActivity = Activity::IDLE;
-                c.activityTimer = Utils::random(3.0f, 8.0f);
-            } else {
-                // Interact / Work (if farmer)
-                c.currentActivity = Activity::WORKING; // e.g. bending down
-                c.activityTimer = Utils::random(4.0f, 10.0f);
+    namespace {
+        const float TALK_DISTANCE = 3.0f;
+        const float GRID_CELL = 4.0f; // Wider than TALK_DISTANCE: a query touches at most 3 cells
+        
+        thread_local ProximityGrid scratchGrid; // Worker threads step their own worlds
+        
+        int cellIndex(const ProximityGrid& grid, float x) {
+            int c = int(std::floor((x - grid.x0) / GRID_CELL));
+            if (c < 0) return 0;
+            if (c >= int(grid.cells.size())) return int(grid.cells.size()) - 1;
+            return c;
+        }
+        
+        void buildGrid(ProximityGrid& grid, const CharacterList& villagers) {
+            // Cover every home range so moves never leave the grid
+            float lo = villagers[0].x, hi = villagers[0].x;
+            for (const auto& v : villagers) {
+                lo = std::min(lo, std::min(v.x, v.homeMin));
+                hi = std::max(hi, std::max(v.x, v.homeMax));
+            }
+            grid.x0 = lo;
+            size_t count = size_t((hi - lo) / GRID_CELL) + 1;
+            grid.cells.resize(count);
+            for (auto& cell : grid.cells) cell.clear();
+            grid.cellOf.resize(villagers.size());
+            for (size_t i = 0; i < villagers.size(); ++i) {
+                grid.cellOf[i] = cellIndex(grid, villagers[i].x);
+                grid.cells[grid.cellOf[i]].push_back(int(i));
+            }
+        }
+        
+        void moveInGrid(ProximityGrid& grid, int i, float x) {
+            int to = cellIndex(grid, x);
+            int from = grid.cellOf[i];
+            if (to == from) return;
+            std::vector<int>& old = grid.cells[from];
+            old.erase(std::find(old.begin(), old.end(), i));
+            std::vector<int>& cell = grid.cells[to];
+            cell.insert(std::lower_bound(cell.begin(), cell.end(), i), i);
+            grid.cellOf[i] = to;
+        }
+        
+        // ticks > 1: a reduced update waiting out a timer (Lod tiers). Returns
+        // how many ticks ago the decision was due (a long step runs past it)
+        int decide(Character& c, int ticks) {
+            c.activityTimer -= 0.1f * float(ticks);
+            int late = 0;
+            if (c.activityTimer <= 0) {
+                if (ticks > 1) late = std::min(int(std::floor(-c.activityTimer / 0.1f)), ticks - 1);
+                
+                // New decision
+                int r = Utils::randomInt(100);
+                if (r < 40) {
+                    // Walk to new random location
+                    c.currentActivity = Activity::WALKING;
+                    c.targetX = Utils::random(c.homeMin, c.homeMax);
+                    c.activityTimer = 20.0f; // Give enough time
+                } else if (r < 70) {
+                    // Just idle
+                    c.currentActivity = Activity::IDLE;
+                    c.activityTimer = Utils::random(3.0f, 8.0f);
+                } else {
+                    // Interact / Work (if farmer)
+                    c.currentActivity = Activity::WORKING; // e.g. bending down
+                    c.activityTimer = Utils::random(4.0f, 10.0f);
+                }
+                c.activityTimer -= 0.1f * float(late);
             }
+            return late;
         }
         
         // Social Interaction Check (Micro-Interaction)
+        void considerTalking(Character& c, const Character& other, int otherIndex) {
+            float dist = std::abs(c.x - other.x);
+            
+            // If close and other is idle/walking, maybe stop to talk
+            if (dist < TALK_DISTANCE && other.currentActivity != Activity::WORKING && Utils::randomInt(100) < 2) {
+                 c.currentActivity = Activity::SOCIALIZING;
+                 c.activityTimer = Utils::random(5.0f, 10.0f);
+                 c.conversationPartnerId = otherIndex;
+                 // Ideally we'd set the other person too, but simplified local logic for now
+            }
+        }
+        
+        // Walkers always take single ticks
+        void move(Character& c, float weatherSpeedMod, int ticks) {
+            if (c.currentActivity == Activity::WALKING) {
+                float dx = c.targetX - c.x;
+                if (std::abs(dx) < 0.5f) {
+                    c.currentActivity = Activity::IDLE;
+                    c.activityTimer = Utils::random(2.0f, 5.0f);
+                } else {
+                    c.direction = (dx > 0) ? 1 : -1;
+                    c.x += c.speed * c.direction * weatherSpeedMod;
+                    c.animFrame += 0.2f * weatherSpeedMod;
+                }
+            } else if (c.currentActivity == Activity::SOCIALIZING) {
+                 // Face each other?
+                 // Just idle anim
+            } else if (c.currentActivity == Activity::WORKING) {
+                 c.animFrame += 0.1f * float(ticks); // Slow work anim
+            }
+            
+            // Keep inside the home range
+            if (c.x < c.homeMin) c.x = c.homeMin;
+            if (c.x > c.homeMax) c.x = c.homeMax;
+        }
+    }
+
+    void update(Character& c, float time, const CharacterList& others, int myIndex, float weatherSpeedMod) {
+        decide(c, 1);
+        
         if (c.currentActivity == Activity::WALKING) {
             for (size_t i = 0; i < others.size(); ++i) {
                 if (int(i) == myIndex) continue;
-                
-                const Character& other = others[i];
-                float dist = std::abs(c.x - other.x);
-                
-                // If close and other is idle/walking, maybe stop to talk
-                if (dist < 3.0f && other.currentActivity != Activity::WORKING && rand() % 100 < 2) {
-                     c.currentActivity = Activity::SOCIALIZING;
-                     c.activityTimer = Utils::random(5.0f, 10.0f);
-                     c.conversationPartnerId = int(i);
-                     // Ideally we'd set the other person too, but simplified local logic for now
-                }
+                considerTalking(c, others[i], int(i));
             }
         }
 
-        // Logic
-        if (c.currentActivity == Activity::WALKING) {
-            float dx = c.targetX - c.x;
-            if (std::abs(dx) < 0.5f) {
-                c.currentActivity = Activity::IDLE;
-                c.activityTimer = Utils::random(2.0f, 5.0f);
-            } else {
-                c.direction = (dx > 0) ? 1 : -1;
-                c.x += c.speed * c.direction * weatherSpeedMod;
-                c.animFrame += 0.2f * weatherSpeedMod;
-            }
-        } else if (c.currentActivity == Activity::SOCIALIZING) {
-             // Face each other?
-             // Just idle anim
-        } else if (c.currentActivity == Activity::WORKING) {
-             c.animFrame += 0.1f; // Slow work anim
+        move(c, weatherSpeedMod, 1);
+    }
+    
+    namespace {
+        void updateOne(CharacterList& villagers, size_t i, float weatherSpeedMod, const Lod::Frame* lod, ProximityGrid& grid) {
+            Character& c = villagers[i];
+            bool wasWalking = (c.currentActivity == Activity::WALKING);
+            int ticks = 1;
+            if (lod && !wasWalking) {
+                // Walks are short where it is crowded (the first conversation ends
+                // them), so walkers keep the full rate; only timers are coarsened
+                ticks = Lod::ticksFor(*lod, c.x, i);
+                if (ticks == 0) return;
+            }
+            int late = decide(c, ticks);
+            if (c.currentActivity == Activity::WALKING) {
+                // Walking from here on, having set off when the decision was due
+                ticks = 1;
+                for (int k = 0; k < late && c.currentActivity == Activity::WALKING; k++) move(c, weatherSpeedMod, 1);
+            }
+            
+            if (c.currentActivity == Activity::WALKING) {
+                // Neighbours from the cells in reach, visited in index order like the full scan
+                grid.candidates.clear();
+                int last = cellIndex(grid, c.x + TALK_DISTANCE);
+                for (int cell = cellIndex(grid, c.x - TALK_DISTANCE); cell <= last; ++cell) {
+                    grid.candidates.insert(grid.candidates.end(), grid.cells[cell].begin(), grid.cells[cell].end());
+                }
+                std::sort(grid.candidates.begin(), grid.candidates.end());
+                for (int other : grid.candidates) {
+                    if (other == int(i)) continue;
+                    considerTalking(c, villagers[other], other);
+                }
+            }
+            
+            move(c, weatherSpeedMod, ticks);
+            moveInGrid(grid, int(i), c.x);
+            
+            // A walk just ended off-screen: the next reduced update also spans ticks walked already
+            if (lod && wasWalking && c.currentActivity != Activity::WALKING) {
+                c.activityTimer += 0.1f * float(Lod::coveredTicks(*lod, c.x, i));
+            }
+        }
+        
+        // Ticks until decide() finds the timer run out. Counting down drifts from
+        // timer / 0.1 by far less than 1% of a step over any timer this short,
+        // so only a near tie needs the exact count
+        long long ticksLeft(float timer) {
+            double q = double(timer) / double(0.1f);
+            long long n = std::max(1LL, (long long)std::ceil(q));
+            if (timer < 50.0f && q - std::floor(q) > 0.01 && std::ceil(q) - q > 0.01) return n;
+            while (n > 1 && Utils::addRepeated(timer, -0.1f, n - 1) <= 0.0f) n--;
+            while (Utils::addRepeated(timer, -0.1f, n) > 0.0f) n++;
+            return n;
+        }
+        
+        void updateDormant(CharacterList& villagers, float weatherSpeedMod, Dormancy::Villagers& d) {
+            typedef std::pair<long long, int> Due;
+            
+            // 1. Everyone starts out active (the lists were dropped, or the villagers changed without settle())
+            if (!d.built || d.since.size() != villagers.size()) {
+                d.built = true;
+                d.tick = 0;
+                d.active.resize(villagers.size());
+                for (size_t i = 0; i < villagers.size(); ++i) d.active[i] = int(i);
+                d.since.assign(villagers.size(), -1);
+                d.waking.clear();
+                buildGrid(d.grid, villagers);
+            }
+            d.tick++;
+            
+            // 2. This tick: the active villagers and those whose timer runs out now, in index order
+            size_t woken = d.active.size();
+            d.pass.assign(d.active.begin(), d.active.end());
+            while (!d.waking.empty() && d.waking.front().first <= d.tick) {
+                int i = d.waking.front().second;
+                std::pop_heap(d.waking.begin(), d.waking.end(), std::greater<Due>());
+                d.waking.pop_back();
+                // Only the work animation shows: the timer is about to be replaced
+                Character& c = villagers[i];
+                if (c.currentActivity == Activity::WORKING) wait(c, d.tick - 1 - d.since[i]);
+                c.activityTimer = 0.0f; // Runs out this tick
+                d.since[i] = -1;
+                d.pass.push_back(i);
+            }
+            std::sort(d.pass.begin() + woken, d.pass.end());
+            std::inplace_merge(d.pass.begin(), d.pass.begin() + woken, d.pass.end());
+            
+            // 3. Whoever is left waiting out a timer goes dormant
+            d.active.clear();
+            for (int i : d.pass) {
+                updateOne(villagers, size_t(i), weatherSpeedMod, nullptr, d.grid);
+                const Character& c = villagers[i];
+                if (c.currentActivity == Activity::WALKING) {
+                    d.active.push_back(i);
+                    continue;
+                }
+                d.since[i] = d.tick;
+                d.waking.push_back(Due(d.tick + ticksLeft(c.activityTimer), i));
+                std::push_heap(d.waking.begin(), d.waking.end(), std::greater<Due>());
+            }
+        }
+    }
+    
+    void updateAll(CharacterList& villagers, float time, float weatherSpeedMod, const Lod::Frame* lod, Dormancy::Villagers* dormant) {
+        if (villagers.empty()) return;
+        if (dormant) {
+            updateDormant(villagers, weatherSpeedMod, *dormant);
+            return;
+        }
+        
+        buildGrid(scratchGrid, villagers);
+        for (size_t i = 0; i < villagers.size(); ++i) updateOne(villagers, i, weatherSpeedMod, lod, scratchGrid);
+    }
+    
+    void wait(Character& c, long long ticks) {
+        // decide() counts the timer down, move() plays the work animation
+        c.activityTimer = Utils::addRepeated(c.activityTimer, -0.1f, ticks);
+        if (c.currentActivity == Activity::WORKING) c.animFrame = Utils::addRepeated(c.animFrame, 0.1f, ticks);
+    }
+    
+    void wakeAll(CharacterList& villagers, Dormancy::Villagers& dormant) {
+        if (!dormant.built) return;
+        for (size_t i = 0; i < dormant.since.size() && i < villagers.size(); ++i) {
+            if (dormant.since[i] >= 0) wait(villagers[i], dormant.tick - dormant.since[i]);
+        }
+        dormant.built = false;
+        dormant.active.clear();
+        dormant.since.clear();
+        dormant.waking.clear();
+    }
+    
+    namespace {
+        const float STAY = std::log(0.98f); // Per tick and partner around (considerTalking)
+        const int MAX_RELAX_ROUNDS = 64;    // Crowds have mostly formed by then (a week is about 230 stretches)
+        
+        // Partners (villagers not working, whom walkers stop for) by position, in
+        // half-unit cells. passed sums the partners in reach over a run of
+        // cells, so how many a walk passes is two lookups
+        struct Crowd {
+            float lo;
+            std::vector<long long> passed; // Over the cells before each
+            std::vector<int> in; // Partners by cell, padded by REACH both sides
+            
+            void build(const CharacterList& villagers, const std::vector<char>& partner) {
+                // Cover every home range so walks never leave it
+                lo = villagers[0].x;
+                float hi = lo;
+                for (const auto& v : villagers) {
+                    lo = std::min(lo, std::min(v.x, v.homeMin));
+                    hi = std::max(hi, std::max(v.x, v.homeMax));
+                }
+                size_t cells = size_t((hi - lo) / CELL) + 1;
+                in.assign(cells + 2 * REACH, 0);
+                for (size_t i = 0; i < villagers.size(); ++i) {
+                    if (partner[i]) in[size_t((villagers[i].x - lo) / CELL) + REACH]++;
+                }
+                passed.assign(cells + 1, 0);
+                int reach = 0; // Partners in reach of cell j
+                for (int k = 0; k < 2 * REACH; k++) reach += in[k];
+                for (size_t j = 0; j < cells; ++j) {
+                    reach += in[j + 2 * REACH];
+                    passed[j + 1] = passed[j] + reach;
+                    reach -= in[j];
+                }
+            }
+            
+            int cell(float x) const {
+                return std::max(0, std::min(int((x - lo) / CELL), int(passed.size()) - 2));
+            }
+            
+            static constexpr float CELL = 0.5f;
+            static constexpr int REACH = 6; // TALK_DISTANCE in cells
+        };
+        
+        // Ticks a walk from x towards target lasts (at most ticks) before someone
+        // stops it. Each tick there is a chance per partner within reach of where
+        // the walker has got to; self is whether the walker counts as a partner
+        // at its start
+        double walkUntilTalk(const Crowd& crowd, float x, float target, float perTick, int self, double ticks, bool& talks) {
+            const std::vector<long long>& passed = crowd.passed;
+            int start = crowd.cell(x);
+            bool right = (target > x);
+            int cells = std::min(int(perTick * ticks / Crowd::CELL), right ? int(passed.size()) - 1 - start : start + 1);
+            // Partners passed over the first k cells, less the walker itself
+            auto met = [&](int k) {
+                long long sum = right ? passed[start + k] - passed[start] : passed[start + 1] - passed[start + 1 - k];
+                return double(sum - self * std::min(k, Crowd::REACH + 1));
+            };
+            double perCell = Crowd::CELL / perTick;
+            double need = std::log(Utils::random(1e-6f, 1.0f)) / (STAY * perCell); // Stops once it has passed this many
+            if (cells <= 0 || met(cells) < need) {
+                talks = false;
+                return ticks;
+            }
+            int k0 = 0, k1 = cells; // met(k0) < need <= met(k1)
+            while (k1 - k0 > 1) {
+                int k = (k0 + k1) / 2;
+                if (met(k) < need) k0 = k;
+                else k1 = k;
+            }
+            double before = met(k0);
+            talks = true;
+            return std::min(ticks, (k0 + (need - before) / (met(k1) - before)) * perCell);
+        }
+        
+        // One whole stretch of the routine for everyone, positions only: walkers
+        // head for a spot at home and stop where someone is around. Returns the
+        // mean length of the stretches in ticks
+        double relaxOnce(CharacterList& villagers, std::vector<char>& partner, Crowd& crowd, float weatherSpeedMod) {
+            crowd.build(villagers, partner);
+            double ticks = 0.0;
+            for (size_t i = 0; i < villagers.size(); ++i) {
+                Character& c = villagers[i];
+                int r = Utils::randomInt(100);
+                if (r >= 40) {
+                    partner[i] = (r < 70); // Idle (5.5 on average) or working (7)
+                    ticks += (r < 70) ? 55.0 : 70.0;
+                    continue;
+                }
+                float perTick = c.speed * weatherSpeedMod;
+                float target = Utils::random(c.homeMin, c.homeMax);
+                float dist = std::abs(target - c.x) - 0.5f;
+                double walk = (dist <= 0.0f) ? 0.0 : std::min(200.0, double(std::ceil(dist / perTick)));
+                bool talks;
+                double walked = walkUntilTalk(crowd, c.x, target, perTick, partner[i], walk, talks);
+                float moved = std::min(perTick * float(walked), std::max(dist, 0.0f));
+                c.x += (target > c.x) ? moved : -moved;
+                partner[i] = 1;
+                ticks += walked + (talks ? 75.0 : (walk < 200.0) ? 35.0 : 0.0); // Then talks 5-10 or idles 2-5
+            }
+            return ticks / double(villagers.size());
+        }
+        
+        // self: whether c counts in crowd
+        void resampleOne(Character& c, float weatherSpeedMod, const Crowd& crowd, int self) {
+            // 1. A stretch of the routine, drawn by how long it lasts (a random
+            //    moment more likely falls in a long one). Timer units, a tick is
+            //    0.1. It starts where the villager stands: people spread over
+            //    the village as they do by the end of the skip, crowds and all
+            const float LONGEST = 30.0f; // A 20 walk, then up to 10 talking
+            float perTick = c.speed * weatherSpeedMod;
+            Activity activity;
+            float walk, length;
+            bool talks;
+            do {
+                walk = 0.0f;
+                talks = false;
+                int r = Utils::randomInt(100);
+                if (r < 40) {
+                    activity = Activity::WALKING;
+                    c.targetX = Utils::random(c.homeMin, c.homeMax);
+                    float dist = std::abs(c.targetX - c.x) - 0.5f;
+                    double ticks = (dist <= 0.0f) ? 0.0 : std::min(200.0, double(std::ceil(dist / perTick)));
+                    walk = 0.1f * float(walkUntilTalk(crowd, c.x, c.targetX, perTick, self, ticks, talks)); // Stopped on the way?
+                    if (talks) length = walk + Utils::random(5.0f, 10.0f);
+                    else length = walk + ((walk < 20.0f) ? Utils::random(2.0f, 5.0f) : 0.0f); // Idles on arrival
+                } else if (r < 70) {
+                    activity = Activity::IDLE;
+                    length = Utils::random(3.0f, 8.0f);
+                } else {
+                    activity = Activity::WORKING;
+                    length = Utils::random(4.0f, 10.0f);
+                }
+            } while (Utils::random(0.0f, LONGEST) >= length);
+            
+            // 2. A moment inside it
+            float into = Utils::random(0.0f, length);
+            c.activityTimer = length - into;
+            c.currentActivity = activity;
+            c.conversationPartnerId = -1; // Whoever it was has moved on
+            if (activity == Activity::WALKING) {
+                c.direction = (c.targetX > c.x) ? 1 : -1;
+                c.x += float(c.direction) * perTick * (std::min(into, walk) / 0.1f);
+                if (into < walk) c.activityTimer = 20.0f - into;
+                else c.currentActivity = talks ? Activity::SOCIALIZING : Activity::IDLE;
+            }
+        }
+    }
+    
+    void resample(CharacterList& villagers, float weatherSpeedMod, long long ticks) {
+        if (villagers.empty()) return;
+        std::vector<char> partner(villagers.size());
+        for (size_t i = 0; i < villagers.size(); ++i) partner[i] = (villagers[i].currentActivity != Activity::WORKING);
+        Crowd crowd;
+        
+        // 1. Crowds keep forming for thousands of ticks (walkers stop by whoever
+        //    they pass, and stay there talking), so the crowding at the end of a
+        //    skip is not the one at its start: play whole stretches until the
+        //    skip is covered
+        double covered = 0.0;
+        for (int round = 0; round < MAX_RELAX_ROUNDS && covered < double(ticks); round++) {
+            covered += relaxOnce(villagers, partner, crowd, weatherSpeedMod);
         }
         
-        // Keep on screen
-        if (c.x < -25) c.x = -25;
-        if (c.x > 85) c.x = 85;
+        // 2. Everyone at a random moment of a stretch starting there
+        crowd.build(villagers, partner);
+        for (size_t i = 0; i < villagers.size(); ++i) resampleOne(villagers[i], weatherSpeedMod, crowd, partner[i]);
+    }
+    
+    void queueShadow(const Character& c) {
+        // Shadow/Ground contact (Soft Shadow)
+        Style::queueSoftShadow(c.x, c.y, 1.2f, 0.3f);
     }
     
     void draw(const Character& c, const Utils::Color& ambientLight) {
@@ -104,9 +471,6 @@ namespace CharacterSystem {
         Utils::Color clothes = Style::applyAtmosphere(c.clothingColor, 12, 0.0f);
         clothes.r *= ambientLight.r; clothes.g *= ambientLight.g; clothes.b *= ambientLight.b;
         
-        // Shadow/Ground contact (Soft Shadow)
-        Style::drawSoftShadow(x, y, 1.2f, 0.3f);
-
         // Body Animation
         float legAngle = 0;
         float armAngle = 0;
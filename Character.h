@@ -3,6 +3,10 @@
 
 #include <vector>
 #include "Utils.h"
+#include "Memory.h"
+#include "Lod.h"
+
+namespace Dormancy { struct Villagers; }
 
 enum class Activity {
     IDLE,
@@ -28,12 +32,49 @@ struct Character {
     
     // Social
     int conversationPartnerId; // -1 if none
+    
+    // Walks stay inside [homeMin, homeMax] (create() uses the demo village's range)
+    float homeMin, homeMax;
 };
 
+typedef MemoryTracker::Vector<Character, MemoryTracker::VILLAGERS> CharacterList;
+
 namespace CharacterSystem {
+    // Villager indices bucketed by x, each bucket kept in index order
+    struct ProximityGrid {
+        float x0;
+        std::vector<std::vector<int>> cells;
+        std::vector<int> cellOf; // Per villager
+        std::vector<int> candidates; // Scratch
+        
+        ProximityGrid() : x0(0.0f) {}
+    };
+    
     Character create(float startX);
     
-    void update(Character& c, float time, const std::vector<Character>& others, int myIndex, float weatherSpeedMod);
+    void update(Character& c, float time, const CharacterList& others, int myIndex, float weatherSpeedMod);
+    
+    // update() for every villager in order, finding conversation partners
+    // through a grid over x instead of scanning the whole list (same results).
+    // With lod, villagers waiting out a timer advance Lod::ticksFor ticks instead;
+    // with dormant, they are left alone until it runs out (Dormancy.h)
+    void updateAll(CharacterList& villagers, float time, float weatherSpeedMod, const Lod::Frame* lod = nullptr,
+                   Dormancy::Villagers* dormant = nullptr);
+    
+    // What ticks spent waiting out the timer do to a villager (all at once)
+    void wait(Character& c, long long ticks);
+    // Brings the dormant villagers up to date and drops the lists
+    void wakeAll(CharacterList& villagers, Dormancy::Villagers& dormant);
+    
+    // Every villager at a random moment of its routine, ticks after now (what a
+    // fast forward leaves): activity, timer and position drawn from the mix
+    // the decision rules settle into, talks as likely as the crowd makes them.
+    // The crowds first move on as they would over the skip (whole stretches
+    // of everyone's routine, at most 64)
+    void resample(CharacterList& villagers, float weatherSpeedMod, long long ticks);
+    
+    // Queue the ground shadow for the batched shadow pass (Style::flushSoftShadows)
+    void queueShadow(const Character& c);
     
     void draw(const Character& c, const Utils::Color& ambientLight);
 }
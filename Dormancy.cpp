@@ -0,0 +1,17 @@
+#include "Dormancy.h"
+#include "Scene.h"
+
+namespace Dormancy {
+
+    void settle(Scene::State& state) {
+        CharacterSystem::wakeAll(state.villagers, state.dormant.villagers);
+        AnimalSystem::wakeAll(state.animals, state.dormant.animals);
+    }
+
+    Character villager(const Scene::State& state, size_t i) {
+        Character c = state.villagers[i];
+        const Villagers& d = state.dormant.villagers;
+        if (d.built && d.since[i] >= 0) CharacterSystem::wait(c, d.tick - d.since[i]);
+        return c;
+    }
+}
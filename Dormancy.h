@@ -0,0 +1,57 @@
+#ifndef DORMANCY_H
+#define DORMANCY_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "Character.h"
+#include "Animal.h"
+
+namespace Scene { struct State; }
+
+// Active and dormant partitions of a world's villagers and animals, so a tick
+// only visits what can change.
+// 1. A villager waiting out a timer (idle, working, talking) does nothing but
+//    count it down, and when it runs out is known the moment it starts: it
+//    leaves the active list for a wake queue (worlds without LOD). Walkers
+//    still find it as a talk partner in the grid, which is kept between ticks
+//    since only active villagers move.
+// 2. At night the ground animals sleep until dawn; only the birds are visited.
+// Dormant timers and animation frames are left as they were and brought up to
+// date on waking (Utils::addRepeated: the same floats as ticking them), so a
+// world runs exactly as if everything were updated every tick. Code that reads
+// them, or adds and removes entities, calls settle() first.
+namespace Dormancy {
+    struct Villagers {
+        bool built;
+        long long tick; // updateAll() calls since built
+        std::vector<int> active; // Index order
+        std::vector<long long> since; // Per villager: tick its timer is as of while dormant, -1 when active
+        std::vector<std::pair<long long, int>> waking; // (tick due, villager), a min-heap
+        std::vector<int> pass; // Scratch: this tick's active and due villagers
+        CharacterSystem::ProximityGrid grid;
+
+        Villagers() : built(false), tick(0) {}
+    };
+
+    struct Animals {
+        long long tick; // updateAll() calls
+        long long asleepSince; // Tick the sleepers are as of, -1 by day
+        std::vector<int> awake; // At night: the ones still visited, index order
+
+        Animals() : tick(0), asleepSince(-1) {}
+    };
+
+    struct Lists {
+        Villagers villagers;
+        Animals animals;
+    };
+
+    // Everything awake and up to date; the lists are rebuilt on the next step
+    void settle(Scene::State& state);
+
+    // Villager i as it is now (for drawing: a dormant worker's animation is behind)
+    Character villager(const Scene::State& state, size_t i);
+}
+
+#endif // DORMANCY_H
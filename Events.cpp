@@ -1,5 +1,7 @@
 #include "Events.h"
 #include <GL/glut.h>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include "Utils.h"
@@ -13,6 +15,56 @@ namespace EventSystem {
         state.currentEventName = "";
     }
 
+    namespace {
+        // A check comes round every ~100 units (approx 2 days): 30% chance of
+        // whichever event the hour allows
+        void check(EventState& state, float timeOfDay) {
+            state.eventTimer = 0.0f;
+            // Chance to start event
+            int r = Utils::randomInt(100);
+            if (r < 30) {
+                // Start Market Day (Morning only)
+                if (timeOfDay > 6.0f && timeOfDay < 10.0f) {
+                    state.currentEvent = EventType::MARKET_DAY;
+                    state.isActive = true;
+                    state.currentEventName = "Market Day";
+                    state.eventTimer = 0.0f; // Reuse timer for duration
+                } 
+                // Start Fireflies (Night only)
+                else if (timeOfDay > 20.0f || timeOfDay < 4.0f) {
+                    state.currentEvent = EventType::FIREFLIES;
+                    state.isActive = true;
+                    state.currentEventName = "Firefly Swarm";
+                    state.eventTimer = 0.0f;
+                }
+                // Start Birds (Sunrise only)
+                else if (timeOfDay > 5.0f && timeOfDay < 6.5f) {
+                    state.currentEvent = EventType::BIRD_CONGREGATION;
+                    state.isActive = true;
+                    state.currentEventName = "Bird Gathering";
+                    state.eventTimer = 0.0f;
+                }
+            }
+        }
+        
+        // Hours from timeOfDay until the active event is over (0: at the next update)
+        float hoursLeft(EventType type, float timeOfDay) {
+            if (type == EventType::MARKET_DAY) return (timeOfDay > 18.0f) ? 0.0f : 18.0f - timeOfDay;
+            if (type == EventType::FIREFLIES) {
+                if (timeOfDay > 5.0f && timeOfDay < 20.0f) return 0.0f;
+                return (timeOfDay <= 5.0f) ? 5.0f - timeOfDay : 29.0f - timeOfDay;
+            }
+            if (type == EventType::BIRD_CONGREGATION) return (timeOfDay > 8.0f) ? 0.0f : 8.0f - timeOfDay;
+            return 0.0f;
+        }
+        
+        void end(EventState& state) {
+            state.isActive = false;
+            state.currentEvent = EventType::NONE;
+            state.currentEventName = "";
+        }
+    }
+
     void update(EventState& state, float timeSpeed, float timeOfDay) {
         state.eventTimer += timeSpeed;
         
@@ -21,55 +73,33 @@ namespace EventSystem {
         // Let's use timer.
         
         if (!state.isActive) {
-            if (state.eventTimer > 100.0f) { // Every ~100 units (approx 2 days)
-                state.eventTimer = 0.0f;
-                // Chance to start event
-                int r = rand() % 100;
-                if (r < 30) {
-                    // Start Market Day (Morning only)
-                    if (timeOfDay > 6.0f && timeOfDay < 10.0f) {
-                        state.currentEvent = EventType::MARKET_DAY;
-                        state.isActive = true;
-                        state.currentEventName = "Market Day";
-                        state.eventTimer = 0.0f; // Reuse timer for duration
-                    } 
-                    // Start Fireflies (Night only)
-                    else if (timeOfDay > 20.0f || timeOfDay < 4.0f) {
-                        state.currentEvent = EventType::FIREFLIES;
-                        state.isActive = true;
-                        state.currentEventName = "Firefly Swarm";
-                        state.eventTimer = 0.0f;
-                    }
-                    // Start Birds (Sunrise only)
-                    else if (timeOfDay > 5.0f && timeOfDay < 6.5f) {
-                        state.currentEvent = EventType::BIRD_CONGREGATION;
-                        state.isActive = true;
-                        state.currentEventName = "Bird Gathering";
-                        state.eventTimer = 0.0f;
-                    }
-                }
-            }
+            if (state.eventTimer > 100.0f) check(state, timeOfDay);
         } else {
             // Event Active Logic
             if (state.currentEvent == EventType::MARKET_DAY) {
-                if (timeOfDay > 18.0f) {
-                    state.isActive = false;
-                    state.currentEvent = EventType::NONE;
-                    state.currentEventName = "";
-                }
+                if (timeOfDay > 18.0f) end(state);
             } else if (state.currentEvent == EventType::FIREFLIES) {
-                if (timeOfDay > 5.0f && timeOfDay < 20.0f) {
-                    state.isActive = false;
-                    state.currentEvent = EventType::NONE;
-                     state.currentEventName = "";
-                }
+                if (timeOfDay > 5.0f && timeOfDay < 20.0f) end(state);
             } else if (state.currentEvent == EventType::BIRD_CONGREGATION) {
-                if (timeOfDay > 8.0f) { // Disperse by 8am
-                    state.isActive = false;
-                    state.currentEvent = EventType::NONE;
-                    state.currentEventName = "";
-                }
+                if (timeOfDay > 8.0f) end(state); // Disperse by 8am
+            }
+        }
+    }
+    
+    void skip(EventState& state, float hours, float timeOfDay) {
+        // From one check or end to the next; there are only a few a week
+        while (hours > 0.0f) {
+            float until = state.isActive ? hoursLeft(state.currentEvent, timeOfDay)
+                                         : std::max(100.0f - state.eventTimer, 0.0f);
+            if (until >= hours) {
+                state.eventTimer += hours;
+                return;
             }
+            hours -= until;
+            timeOfDay = std::fmod(timeOfDay + until, 24.0f);
+            state.eventTimer += until;
+            if (state.isActive) end(state);
+            else check(state, timeOfDay);
         }
     }
 
@@ -108,14 +138,14 @@ namespace EventSystem {
         }
     }
     
-    void drawScreen(const EventState& state, int width, int height) {
+    void drawScreen(const EventState& state, int width, int height, float time) {
         if (!state.isActive) return;
         
         if (state.currentEvent == EventType::FIREFLIES) {
             glEnable(GL_BLEND);
             glBlendFunc(GL_SRC_ALPHA, GL_ONE);
             for(int i=0; i<30; i++) {
-                float t = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
+                float t = time;
                 float x = fmod(i * 133.5f + t * 5.0f, float(width));
                 float y = fmod(i * 77.2f + t * 4.0f, float(height * 0.4f)) + 10.0f; // Lower half
                 
@@ -22,12 +22,14 @@ struct EventState {
 namespace EventSystem {
     void init(EventState& state);
     void update(EventState& state, float timeSpeed, float timeOfDay);
+    // hours of update() from timeOfDay on, one check or end at a time
+    void skip(EventState& state, float hours, float timeOfDay);
     
     // World Space Elements (Decorations)
     void drawWorld(const EventState& state);
     
-    // Screen Space Elements (Fireflies)
-    void drawScreen(const EventState& state, int width, int height);
+    // Screen Space Elements (Fireflies), animated on simulation time (seconds) so replays look the same
+    void drawScreen(const EventState& state, int width, int height, float time);
 }
 
 #endif // EVENTS_H
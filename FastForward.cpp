@@ -0,0 +1,163 @@
+#include "FastForward.h"
+#include "Scene.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace FastForward {
+
+    namespace {
+        const char* ACTIVITY_NAMES[4] = { "idle", "walking", "working", "socializing" };
+        const char* ANIMAL_NAMES[3] = { "cow", "sheep", "bird" };
+        const char* ANIMAL_STATE_NAMES[5] = { "idle", "grazing", "moving", "sleeping", "flying" };
+        const int SHARES = 4 + 3 * 5;
+
+        // Villager activity shares, then each animal type's state shares (NaN:
+        // no such animals); counts[] is how many each share is taken over
+        void shares(Scene::State& state, double out[SHARES], double counts[SHARES]) {
+            Dormancy::settle(state);
+            double villagers[4] = {};
+            double animals[3][5] = {};
+            for (const auto& v : state.villagers) villagers[int(v.currentActivity)]++;
+            for (const auto& a : state.animals) animals[int(a.type)][int(a.currentState)]++;
+            for (int i = 0; i < 4; i++) {
+                out[i] = villagers[i] / double(state.villagers.size());
+                counts[i] = double(state.villagers.size());
+            }
+            for (int type = 0; type < 3; type++) {
+                double total = 0.0;
+                for (int s = 0; s < 5; s++) total += animals[type][s];
+                for (int s = 0; s < 5; s++) {
+                    out[4 + type * 5 + s] = animals[type][s] / total;
+                    counts[4 + type * 5 + s] = total;
+                }
+            }
+        }
+    }
+
+    void advance(Scene::State& state, double hours) {
+        if (hours <= 0.0 || state.timeSpeed <= 0.0f) return;
+        PROFILE_SCOPE("FastForward");
+        long long ticks = std::max(1LL, std::llround(hours / state.timeSpeed));
+        float startTime = state.timeOfDay;
+        state.dormant = Dormancy::Lists(); // Everyone is drawn afresh, stale timers included
+
+        // 1. Clocks
+        state.tick += ticks;
+        state.timeOfDay = float(std::fmod(double(state.timeOfDay) + hours, 24.0));
+        double seasonTimer = double(state.seasonTimer) + hours;
+        long long seasons = (long long)std::floor(seasonTimer / 48.0); // Every 2 days
+        state.seasonTimer = float(seasonTimer - 48.0 * double(seasons));
+        state.currentSeason = (Utils::Season)((int(state.currentSeason) + int(seasons % 4)) % 4);
+        WeatherSystem::skip(state.weather, state.timeSpeed * 50.0f, ticks, state.width, state.height);
+        EventSystem::skip(state.events, float(hours), startTime);
+
+        // 2. Sky, lights and wind for the new hour
+        state.waveOffset += 0.1f * float(ticks);
+        Scene::updateSkyColors(state);
+        state.currentWindSway = WeatherSystem::getWindSway(state.weather, state.timeOfDay + state.waveOffset);
+        LightingSystem::updateSchedule(state.lights, state.timeOfDay);
+
+        // 3. Particles and what feeds them
+        bool isNight = (state.timeOfDay < 6.0f || state.timeOfDay > 19.0f);
+        float wind = state.weather.windStrength;
+        ParticleSystem::skip(state.particles, ticks, state.currentSeason, wind, state.width, state.height);
+        for (auto& house : state.houses) {
+            Building::skip(house, state.particles, state.timeOfDay, isNight, ticks, wind, state.width, state.height);
+        }
+        for (const auto& e : state.emitters) {
+            ParticleSystem::skipSmoke(state.particles, e.x, e.y, e.rate, ticks, wind, state.width, state.height);
+        }
+
+        // 4. Villagers and animals, drawn afresh
+        float speedMod = WeatherSystem::walkSpeedMod(state.weather);
+        CharacterSystem::resample(state.villagers, speedMod, ticks);
+        for (auto& a : state.animals) AnimalSystem::resample(a, isNight);
+
+        // 5. Scenery and the heatmap's history
+        for (int i = 0; i < 3; i++) {
+            state.layers[i].x += (state.layers[i].speed + wind * 0.01f) * float(ticks);
+        }
+        state.boatX = -30.0f + float(std::fmod(double(state.boatX) + 30.0 + 0.05 * double(ticks), 130.0));
+        Analytics::decayHeatmap(state.heatmap, ticks);
+    }
+
+    double hoursToDawn(const Scene::State& state) {
+        double hours = 6.0 - double(state.timeOfDay);
+        if (hours <= 0.0) hours += 24.0;
+        return hours;
+    }
+
+    int check(int argc, char** argv) {
+        double hours = 48.0;
+        int warmup = 0;
+        double tolerance = 2.0;
+        unsigned seed = 1;
+        Scene::WorldConfig world;
+
+        // --scene first: it sets the world, the size options then adjust it
+        static SceneFile::Layout layout;
+        for (int i = 1; i + 1 < argc; i++) {
+            if (strcmp(argv[i], "--scene") != 0) continue;
+            if (!SceneFile::load(argv[i + 1], layout)) return 1;
+            world = Scene::WorldConfig(layout);
+        }
+
+        for (int i = 1; i < argc; i++) {
+            bool more = i + 1 < argc;
+            if (strcmp(argv[i], "--hours") == 0 && more) hours = atof(argv[++i]);
+            else if (strcmp(argv[i], "--warmup") == 0 && more) warmup = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--tolerance") == 0 && more) tolerance = atof(argv[++i]);
+            else if (strcmp(argv[i], "--seed") == 0 && more) seed = unsigned(strtoul(argv[++i], nullptr, 10));
+            else if (strcmp(argv[i], "--villagers") == 0 && more) world.villagers = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--animals") == 0 && more) world.animals = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--houses") == 0 && more) world.houses = atoi(argv[++i]);
+        }
+
+        // 1. One world, the weather pinned (it sets the walking speed, and a
+        //    skip only sees the weather it ends in)
+        Utils::seedRandom(seed);
+        Scene::State skipped;
+        Scene::buildWorld(skipped, world);
+        skipped.weather.currentType = WeatherType::CLEAR;
+        skipped.weather.intensity = 0.0f;
+        skipped.weather.holdType = true;
+        for (int i = 0; i < warmup; i++) Scene::step(skipped);
+        Scene::State stepped = skipped;
+
+        // 2. Skip one copy, step the other
+        long long ticks = std::max(1LL, std::llround(hours / skipped.timeSpeed));
+        long long startNs = Profiler::nowNs();
+        advance(skipped, hours);
+        double skipMs = (Profiler::nowNs() - startNs) * 1e-6;
+        startNs = Profiler::nowNs();
+        for (long long t = 0; t < ticks; t++) Scene::step(stepped);
+        double stepMs = (Profiler::nowNs() - startNs) * 1e-6;
+
+        // 3. Compare
+        double a[SHARES], b[SHARES], n[SHARES], m[SHARES];
+        shares(skipped, a, n);
+        shares(stepped, b, m);
+        printf("skip check: %zu villagers, %zu animals, %d warmup ticks, %.1f h (%lld ticks), weather held clear\n",
+               skipped.villagers.size(), skipped.animals.size(), warmup, hours, ticks);
+        printf("%-24s %8s %8s %8s %8s\n", "share", "skipped", "stepped", "points", "allowed");
+        int failed = 0;
+        for (int i = 0; i < SHARES; i++) {
+            if (std::isnan(a[i]) || std::isnan(b[i]) || (a[i] == 0.0 && b[i] == 0.0)) continue;
+            char name[64];
+            if (i < 4) snprintf(name, sizeof(name), "villager.%s", ACTIVITY_NAMES[i]);
+            else snprintf(name, sizeof(name), "%s.%s", ANIMAL_NAMES[(i - 4) / 5], ANIMAL_STATE_NAMES[(i - 4) % 5]);
+            // Small herds are noisy: three standard errors of the difference on top
+            double p = 0.5 * (a[i] + b[i]);
+            double points = 100.0 * (a[i] - b[i]);
+            double allowed = tolerance + 300.0 * std::sqrt(p * (1.0 - p) * (1.0 / n[i] + 1.0 / m[i]));
+            if (std::abs(points) > allowed) failed++;
+            printf("%-24s %8.3f %8.3f %+8.2f %8.2f%s\n", name, a[i], b[i], points, allowed, (std::abs(points) > allowed) ? "  FAIL" : "");
+        }
+        printf("%d shares out of bounds; skip %.1f ms, stepping %.1f s\n", failed, skipMs, stepMs * 1e-3);
+        return failed ? 1 : 0;
+    }
+}
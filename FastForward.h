@@ -0,0 +1,34 @@
+#ifndef FASTFORWARD_H
+#define FASTFORWARD_H
+
+namespace Scene { struct State; }
+
+// Skipping a world ahead by hours without stepping it (keys D and W).
+// 1. Clocks are advanced in closed form: time of day, seasons, the weather
+//    and event timers. A weather or event draw only depends on the hour it
+//    falls on, so only the draws that still count are made (the last weather
+//    transition, the event checks and ends in between).
+// 2. Particles age in one go and the steady flows (seasonal drift, chimneys,
+//    emitters) are topped up to where they would stand.
+// 3. Villagers and animals are not replayed. Their decisions forget the past
+//    within minutes of game time, so after a skip each one is drawn afresh
+//    from the mix of activities the rules settle into (resample()), after
+//    the crowds have moved on as they would over the skip.
+// The tick counter moves on by the ticks the skip stands for, so streamed
+// chunks that were stored catch up as usual when the camera comes back.
+namespace FastForward {
+    // Advance by hours of game time (as many ticks as that is at timeSpeed)
+    void advance(Scene::State& state, double hours);
+
+    // Hours from now to the next 06:00, when the night ends
+    double hoursToDawn(const Scene::State& state);
+
+    // village.exe --skip-check: skips a fresh world (--scene, --seed, --hours,
+    // --warmup) and steps a copy of it through the same hours with the weather
+    // held clear, then prints both activity mixes. Exit code 1 if any share is
+    // further apart than --tolerance percentage points (default 2) plus three
+    // standard errors of sampling noise
+    int check(int argc, char** argv);
+}
+
+#endif // FASTFORWARD_H
@@ -0,0 +1,268 @@
+#include "Fork.h"
+#include "Profiler.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+
+namespace WorldFork {
+
+    namespace {
+        const char* WEATHER_NAMES[4] = { "clear", "rain", "snow", "storm" };
+        const char* SEASON_NAMES[4] = { "spring", "summer", "autumn", "winter" };
+
+        // The arrays of a State that live in chunks
+        struct Arrays {
+            BuildingList houses;
+            CharacterList villagers;
+            AnimalList animals;
+            EmitterList emitters;
+            DecorationList decorations;
+            decltype(LightRegistry::lights) lights;
+            decltype(WeatherState::particles) weatherParticles;
+            ParticleList particles;
+        };
+
+        void swapArrays(Scene::State& s, Arrays& a) {
+            s.houses.swap(a.houses);
+            s.villagers.swap(a.villagers);
+            s.animals.swap(a.animals);
+            s.emitters.swap(a.emitters);
+            s.decorations.swap(a.decorations);
+            s.lights.lights.swap(a.lights);
+            s.weather.particles.swap(a.weatherParticles);
+            s.particles.pool.swap(a.particles);
+        }
+
+        // Fold list back into cow: unchanged chunks stay shared, changed ones are
+        // overwritten if this world holds the only reference, copied otherwise
+        template <class List>
+        void store(CowArray<List>& cow, const List& list) {
+            typedef typename List::value_type T;
+            static_assert(std::is_trivially_copyable<T>::value, "chunks are compared and copied as raw bytes");
+            const size_t per = std::max<size_t>(1, CHUNK_BYTES / sizeof(T));
+
+            cow.chunks.resize((list.size() + per - 1) / per);
+            for (size_t c = 0; c < cow.chunks.size(); c++) {
+                size_t begin = c * per;
+                size_t len = std::min(per, list.size() - begin);
+                const T* src = list.data() + begin;
+
+                std::shared_ptr<List>& chunk = cow.chunks[c];
+                if (chunk && chunk->size() == len && memcmp((const void*)chunk->data(), (const void*)src, len * sizeof(T)) == 0) continue;
+                if (chunk && chunk.use_count() == 1) {
+                    // use_count() is a relaxed load: order it after the other world's last read before it let go
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    chunk->assign(src, src + len);
+                } else {
+                    chunk = std::make_shared<List>(src, src + len);
+                }
+            }
+            cow.count = list.size();
+        }
+
+        template <class List>
+        void load(const CowArray<List>& cow, List& list) {
+            list.clear();
+            list.reserve(cow.count);
+            for (const auto& chunk : cow.chunks) list.insert(list.end(), chunk->begin(), chunk->end());
+        }
+
+        template <class List>
+        void addUsage(Usage& u, std::unordered_set<const void*>& seen, const CowArray<List>& cow) {
+            for (const auto& chunk : cow.chunks) {
+                size_t bytes = chunk->size() * sizeof(typename List::value_type);
+                u.logicalBytes += bytes;
+                u.chunks++;
+                if (seen.insert(chunk.get()).second) {
+                    u.uniqueBytes += bytes;
+                    u.uniqueChunks++;
+                }
+            }
+        }
+
+        // The State copy itself (Metrics is inline) and what it still owns on the heap
+        size_t scalarBytes(const Scene::State& s) {
+            return sizeof(s) + s.heatmap.density.capacity() * sizeof(float)
+                 + s.lights.freeSlots.capacity() * sizeof(LightHandle) + s.events.currentEventName.capacity();
+        }
+    }
+
+    void capture(World& w, Scene::State& s) {
+        // 1. Scalars (park the arrays so the copy does not duplicate them; no dormant lists either)
+        Dormancy::settle(s);
+        Arrays parked;
+        swapArrays(s, parked);
+        w.scalars = s;
+        swapArrays(s, parked);
+        w.rngState = Utils::getRandomState();
+
+        // 2. Chunked arrays
+        store(w.houses, s.houses);
+        store(w.villagers, s.villagers);
+        store(w.animals, s.animals);
+        store(w.emitters, s.emitters);
+        store(w.decorations, s.decorations);
+        store(w.lights, s.lights.lights);
+        store(w.weatherParticles, s.weather.particles);
+        store(w.particles, s.particles.pool);
+    }
+
+    void expand(const World& w, Scene::State& s) {
+        // Keep s's arrays (and their capacity) across the scalar assignment
+        Arrays parked;
+        swapArrays(s, parked);
+        s = w.scalars;
+        swapArrays(s, parked);
+
+        load(w.houses, s.houses);
+        load(w.villagers, s.villagers);
+        load(w.animals, s.animals);
+        load(w.emitters, s.emitters);
+        load(w.decorations, s.decorations);
+        load(w.lights, s.lights.lights);
+        load(w.weatherParticles, s.weather.particles);
+        load(w.particles, s.particles.pool);
+        Utils::setRandomState(w.rngState);
+    }
+
+    void reseed(World& w, unsigned seed) {
+        unsigned long long saved = Utils::getRandomState();
+        Utils::seedRandom(seed);
+        w.rngState = Utils::getRandomState();
+        Utils::setRandomState(saved);
+    }
+
+    void advance(World& w, int ticks, Scene::State& scratch) {
+        expand(w, scratch);
+        for (int i = 0; i < ticks; i++) Scene::step(scratch);
+        capture(w, scratch);
+    }
+
+    void advanceAll(std::vector<World>& worlds, int ticks, int threads) {
+        if (threads <= 0) threads = int(std::max(1u, std::thread::hardware_concurrency()));
+        threads = std::max(1, std::min(threads, int(worlds.size())));
+
+        // Workers pull the next unclaimed world; each owns one scratch State
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            Scene::State scratch;
+            for (size_t i = next.fetch_add(1); i < worlds.size(); i = next.fetch_add(1)) {
+                advance(worlds[i], ticks, scratch);
+            }
+        };
+
+        unsigned long long callerRng = Utils::getRandomState();
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+        worker(); // The calling thread takes a share too
+        for (auto& t : pool) t.join();
+        Utils::setRandomState(callerRng);
+    }
+
+    Usage usage(const std::vector<World>& worlds) {
+        Usage u = Usage();
+        std::unordered_set<const void*> seen;
+        for (const auto& w : worlds) {
+            u.stateBytes += scalarBytes(w.scalars);
+            addUsage(u, seen, w.houses);
+            addUsage(u, seen, w.villagers);
+            addUsage(u, seen, w.animals);
+            addUsage(u, seen, w.emitters);
+            addUsage(u, seen, w.decorations);
+            addUsage(u, seen, w.lights);
+            addUsage(u, seen, w.weatherParticles);
+            addUsage(u, seen, w.particles);
+        }
+        u.logicalBytes += u.stateBytes;
+        u.uniqueBytes += u.stateBytes;
+        return u;
+    }
+
+    int run(int argc, char** argv) {
+        int branches = 16;
+        int ticks = 2400; // One in-game day
+        int warmup = 0;
+        int threads = 0;
+        unsigned seed = 12345;
+        Scene::WorldConfig world;
+        const char* snapshotPath = nullptr;
+
+        // --scene first: it sets the world, the size options then adjust it
+        static SceneFile::Layout layout;
+        for (int i = 1; i + 1 < argc; i++) {
+            if (strcmp(argv[i], "--scene") != 0) continue;
+            if (!SceneFile::load(argv[i + 1], layout)) return 1;
+            world = Scene::WorldConfig(layout);
+        }
+
+        for (int i = 1; i < argc; i++) {
+            bool more = i + 1 < argc;
+            if (strcmp(argv[i], "--branches") == 0 && more) branches = std::max(1, atoi(argv[++i]));
+            else if (strcmp(argv[i], "--ticks") == 0 && more) ticks = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--warmup") == 0 && more) warmup = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--threads") == 0 && more) threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--seed") == 0 && more) seed = unsigned(strtoul(argv[++i], nullptr, 10));
+            else if (strcmp(argv[i], "--villagers") == 0 && more) world.villagers = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--animals") == 0 && more) world.animals = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--houses") == 0 && more) world.houses = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--emitters") == 0 && more) world.emitters = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--particles") == 0 && more) world.particlePool = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--snapshot") == 0 && more) snapshotPath = argv[++i];
+        }
+
+        // 1. The common checkpoint: a generated (or saved) world, optionally run for a while
+        Utils::seedRandom(seed);
+        Scene::buildWorld(world);
+        if (snapshotPath && !Snapshot::load(snapshotPath)) {
+            fprintf(stderr, "Fork: cannot load %s\n", snapshotPath);
+            return 1;
+        }
+        Scene::State& state = Scene::getState();
+        for (int i = 0; i < warmup; i++) Scene::step(state);
+
+        World root;
+        capture(root, state);
+
+        // 2. Branches start as copies of the root and differ only in their random sequence
+        std::vector<World> worlds(branches, root);
+        for (int i = 0; i < branches; i++) reseed(worlds[i], seed + 1 + unsigned(i));
+        Usage before = usage(worlds);
+
+        long long startNs = Profiler::nowNs();
+        advanceAll(worlds, ticks, threads);
+        double seconds = (Profiler::nowNs() - startNs) * 1e-9;
+        Usage after = usage(worlds);
+
+        // 3. Report
+        const double MB = 1.0 / (1024.0 * 1024.0);
+        printf("%d branches x %d ticks from tick %lld in %.3f s (%.0f world-ticks/s)\n",
+               branches, ticks, root.scalars.tick, seconds, seconds > 0 ? branches * (double)ticks / seconds : 0.0);
+        printf("worlds at fork: %.2f MB held (%.2f MB as full copies), %.2f MB of it per-branch state\n",
+               before.uniqueBytes * MB, before.logicalBytes * MB, before.stateBytes * MB);
+        printf("worlds after:   %.2f MB held (%.2f MB as full copies), %zu of %zu chunks still shared\n",
+               after.uniqueBytes * MB, after.logicalBytes * MB, after.chunks - after.uniqueChunks, after.chunks);
+
+        printf("\n%-6s %-8s %-7s %-6s %-9s %-18s %9s %10s\n", "branch", "seed", "season", "weather", "intensity", "event", "particles", "villagerX");
+        for (int i = 0; i < branches; i++) {
+            const World& w = worlds[i];
+            const Scene::State& s = w.scalars;
+
+            double sumX = 0.0;
+            for (const auto& chunk : w.villagers.chunks) {
+                for (const auto& v : *chunk) sumX += v.x;
+            }
+
+            printf("%-6d %-8u %-7s %-7s %9.2f %-18s %9d %10.2f\n", i, seed + 1 + unsigned(i),
+                   SEASON_NAMES[int(s.currentSeason) & 3], WEATHER_NAMES[int(s.weather.currentType) & 3], s.weather.intensity,
+                   s.events.isActive ? s.events.currentEventName.c_str() : "-", s.particles.liveCount,
+                   w.villagers.count ? sumX / w.villagers.count : 0.0);
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef FORK_H
+#define FORK_H
+
+#include "Scene.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Copy-on-write world forks for what-if runs.
+// A World keeps the entity, light and particle arrays of a Scene::State as
+// fixed-size chunks behind shared pointers, so copying a World only copies the
+// chunk tables and every branch shares memory with its parent. Advancing a
+// branch expands it into a scratch State (one per worker thread), steps it,
+// and folds it back chunk by chunk: a chunk whose bytes did not change keeps
+// pointing at the shared copy, only the changed ones are duplicated.
+namespace WorldFork {
+    const size_t CHUNK_BYTES = 16 * 1024;
+
+    // One array split into chunks of the same list type (so chunks are still
+    // counted against the right MemoryTracker tag)
+    template <class List>
+    struct CowArray {
+        std::vector<std::shared_ptr<List>> chunks; // Read-only while shared
+        size_t count;
+
+        CowArray() : count(0) {}
+    };
+
+    struct World {
+        Scene::State scalars; // Everything but the chunked arrays (those are left empty here)
+        unsigned long long rngState;
+
+        CowArray<BuildingList> houses;
+        CowArray<CharacterList> villagers;
+        CowArray<AnimalList> animals;
+        CowArray<EmitterList> emitters;
+        CowArray<DecorationList> decorations;
+        CowArray<decltype(LightRegistry::lights)> lights;
+        CowArray<decltype(WeatherState::particles)> weatherParticles;
+        CowArray<ParticleList> particles;
+
+        World() : rngState(0) {}
+    };
+
+    // Memory held by a set of branches
+    struct Usage {
+        size_t logicalBytes; // As if every branch owned full copies
+        size_t uniqueBytes;  // Distinct chunks actually allocated, plus the branches' own state
+        size_t stateBytes;   // Every branch's scalars copy (metrics histograms, heatmap): never shared
+        size_t chunks;
+        size_t uniqueChunks;
+    };
+
+    // State <-> World (the random generator travels with the world: capture
+    // reads the calling thread's, expand sets it)
+    void capture(World& w, Scene::State& s);
+    void expand(const World& w, Scene::State& s);
+
+    // A branch is a plain copy of its parent (World child = parent);
+    // reseed gives it its own random sequence from here on
+    void reseed(World& w, unsigned seed);
+
+    // Step one world on the calling thread, using scratch as the working State
+    void advance(World& w, int ticks, Scene::State& scratch);
+
+    // Step every world on a pool of worker threads (0 = one per core)
+    void advanceAll(std::vector<World>& worlds, int ticks, int threads = 0);
+
+    Usage usage(const std::vector<World>& worlds);
+
+    // village.exe --fork [--branches N] [--ticks N] ...: what-if runs from one checkpoint
+    int run(int argc, char** argv);
+}
+
+#endif // FORK_H
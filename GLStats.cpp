@@ -0,0 +1,195 @@
+#define GL_STATS_NO_INTERCEPT
+#include "GLStats.h"
+#include <cstring>
+
+namespace GLStats {
+
+    namespace {
+        const int MAX_SECTIONS = 32;
+
+        struct Section {
+            const char* name;
+            Counts frame; // Being accumulated
+            Counts last;  // Published by endFrame
+        };
+
+        Section sections[MAX_SECTIONS] = { { "Other", {}, {} } };
+        int sectionCount = 1;
+        thread_local Counts scratch; // Sink for calls from threads that are not the GL thread
+
+        thread_local bool isGLThread = false;
+        const char* currentName = "Other";
+
+        // Shadow of the state we have seen set, per thread like the sink (batch and
+        // fork workers draw headlessly). Cleared by glPopAttrib since the restored
+        // values are not visible to us.
+        thread_local bool colorKnown = false;
+        thread_local GLfloat color[4];
+        thread_local bool blendKnown = false;
+        thread_local GLenum blendSrc, blendDst;
+        thread_local bool lineKnown = false;
+        thread_local GLfloat lineW;
+
+        const GLenum trackedCaps[] = { GL_BLEND, GL_TEXTURE_2D, GL_LIGHTING, GL_DEPTH_TEST };
+        const int TRACKED_CAPS = sizeof(trackedCaps) / sizeof(trackedCaps[0]);
+        thread_local unsigned capsKnown = 0;
+        thread_local unsigned capsOn = 0;
+
+        int capBit(GLenum cap) {
+            for (int i = 0; i < TRACKED_CAPS; i++) {
+                if (trackedCaps[i] == cap) return 1 << i;
+            }
+            return 0;
+        }
+
+        void setCap(GLenum cap, bool on) {
+            current->stateChanges++;
+            unsigned bit = capBit(cap);
+            if (!bit) return;
+            if ((capsKnown & bit) && bool(capsOn & bit) == on) current->redundant++;
+            capsKnown |= bit;
+            if (on) capsOn |= bit; else capsOn &= ~bit;
+        }
+
+        Counts* findSection(const char* name) {
+            for (int i = 0; i < sectionCount; i++) {
+                if (sections[i].name == name || strcmp(sections[i].name, name) == 0) return &sections[i].frame;
+            }
+            if (sectionCount == MAX_SECTIONS) return &sections[0].frame;
+            sections[sectionCount].name = name;
+            sections[sectionCount].frame = Counts();
+            sections[sectionCount].last = Counts();
+            return &sections[sectionCount++].frame;
+        }
+    }
+
+    thread_local Counts* current = &scratch;
+    bool nullSink = false;
+
+    void setNullSink(bool on) {
+        nullSink = on;
+    }
+
+    void bindThread() {
+        isGLThread = true;
+        current = findSection(currentName);
+    }
+
+    const char* enterSection(const char* name) {
+        if (!isGLThread) return nullptr;
+        const char* previous = currentName;
+        currentName = name;
+        current = findSection(name);
+        return previous;
+    }
+
+    void leaveSection(const char* previous) {
+        if (!isGLThread || !previous) return;
+        currentName = previous;
+        current = findSection(previous);
+    }
+
+    void endFrame() {
+        for (int i = 0; i < sectionCount; i++) {
+            sections[i].last = sections[i].frame;
+            sections[i].frame = Counts();
+        }
+    }
+
+    Counts frameTotals() {
+        Counts t = Counts();
+        for (int i = 0; i < sectionCount; i++) {
+            const Counts& c = sections[i].last;
+            t.batches += c.batches;
+            t.vertices += c.vertices;
+            t.stateChanges += c.stateChanges;
+            t.redundant += c.redundant;
+            t.matrixPushes += c.matrixPushes;
+        }
+        return t;
+    }
+
+    void getSections(std::vector<SectionCounts>& out) {
+        out.clear();
+        for (int i = 0; i < sectionCount; i++) {
+            const Counts& c = sections[i].last;
+            if (c.batches == 0 && c.stateChanges == 0 && c.matrixPushes == 0) continue;
+            SectionCounts s = { sections[i].name, c };
+            out.push_back(s);
+        }
+    }
+
+    void begin(GLenum mode) {
+        current->batches++;
+        if (!nullSink) glBegin(mode);
+    }
+
+    void end() {
+        if (!nullSink) glEnd();
+    }
+
+    void color4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+        current->stateChanges++;
+        if (colorKnown && color[0] == r && color[1] == g && color[2] == b && color[3] == a) current->redundant++;
+        color[0] = r; color[1] = g; color[2] = b; color[3] = a;
+        colorKnown = true;
+        if (!nullSink) glColor4f(r, g, b, a);
+    }
+
+    void enable(GLenum cap) {
+        setCap(cap, true);
+        if (!nullSink) glEnable(cap);
+    }
+
+    void disable(GLenum cap) {
+        setCap(cap, false);
+        if (!nullSink) glDisable(cap);
+    }
+
+    void blendFunc(GLenum src, GLenum dst) {
+        current->stateChanges++;
+        if (blendKnown && blendSrc == src && blendDst == dst) current->redundant++;
+        blendSrc = src; blendDst = dst;
+        blendKnown = true;
+        if (!nullSink) glBlendFunc(src, dst);
+    }
+
+    void lineWidth(GLfloat width) {
+        current->stateChanges++;
+        if (lineKnown && lineW == width) current->redundant++;
+        lineW = width;
+        lineKnown = true;
+        if (!nullSink) glLineWidth(width);
+    }
+
+    void pushMatrix() {
+        current->matrixPushes++;
+        if (!nullSink) glPushMatrix();
+    }
+
+    void pushAttrib(GLbitfield mask) {
+        current->stateChanges++;
+        if (!nullSink) glPushAttrib(mask);
+    }
+
+    void popAttrib() {
+        if (!nullSink) glPopAttrib();
+        colorKnown = blendKnown = lineKnown = false;
+        capsKnown = 0;
+    }
+
+    void drawArrays(GLenum mode, GLint first, GLsizei count) {
+        current->batches++;
+        current->vertices += count;
+        // Array colors leave the current color undefined
+        colorKnown = false;
+        if (!nullSink) glDrawArrays(mode, first, count);
+    }
+
+    void drawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices) {
+        current->batches++;
+        current->vertices += count;
+        colorKnown = false;
+        if (!nullSink) glDrawElements(mode, count, type, indices);
+    }
+}
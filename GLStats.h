@@ -0,0 +1,81 @@
+#ifndef GL_STATS_H
+#define GL_STATS_H
+
+#include <GL/glut.h>
+#include <vector>
+
+// GL call accounting.
+// Including this header (Utils.h does) routes the GL entry points used by the
+// renderer through thin counting wrappers. Counts are attributed to the
+// innermost profiler scope of the GL thread and reset every frame; other
+// threads (headless batch and fork workers) count into a sink of their own.
+namespace GLStats {
+    struct Counts {
+        int batches;      // glBegin/glEnd pairs and glDraw* calls
+        int vertices;
+        int stateChanges; // Enable/Disable, BlendFunc, LineWidth, Color, PushAttrib
+        int redundant;    // State changes that set the value already current
+        int matrixPushes;
+    };
+
+    struct SectionCounts {
+        const char* name;
+        Counts counts;
+    };
+
+    extern thread_local Counts* current; // Section receiving this thread's counts right now
+    extern bool nullSink;   // Count only, never reach the driver
+
+    // Microbenchmarks run draw code without a GL context through the null sink
+    void setNullSink(bool on);
+
+    // Marks the calling thread as the GL thread (call once from Scene::init)
+    void bindThread();
+
+    // Profiler scopes switch sections; returns the previous section name
+    const char* enterSection(const char* name);
+    void leaveSection(const char* previous);
+
+    // Publishes this frame's counts and clears them (call after each display)
+    void endFrame();
+    Counts frameTotals();
+    void getSections(std::vector<SectionCounts>& out); // Last frame, non-empty only
+
+    // State tracking (redundancy is judged against the last value we saw set)
+    void begin(GLenum mode);
+    void end();
+    void color4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+    void enable(GLenum cap);
+    void disable(GLenum cap);
+    void blendFunc(GLenum src, GLenum dst);
+    void lineWidth(GLfloat width);
+    void pushMatrix();
+    void pushAttrib(GLbitfield mask);
+    void popAttrib();
+    void drawArrays(GLenum mode, GLint first, GLsizei count);
+    void drawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+
+    inline void vertex2f(GLfloat x, GLfloat y) {
+        current->vertices++;
+        if (!nullSink) glVertex2f(x, y);
+    }
+}
+
+#ifndef GL_STATS_NO_INTERCEPT
+#define glBegin(mode) GLStats::begin(mode)
+#define glEnd() GLStats::end()
+#define glVertex2f(x, y) GLStats::vertex2f(x, y)
+#define glColor3f(r, g, b) GLStats::color4f(r, g, b, 1.0f)
+#define glColor4f(r, g, b, a) GLStats::color4f(r, g, b, a)
+#define glEnable(cap) GLStats::enable(cap)
+#define glDisable(cap) GLStats::disable(cap)
+#define glBlendFunc(src, dst) GLStats::blendFunc(src, dst)
+#define glLineWidth(w) GLStats::lineWidth(w)
+#define glPushMatrix() GLStats::pushMatrix()
+#define glPushAttrib(mask) GLStats::pushAttrib(mask)
+#define glPopAttrib() GLStats::popAttrib()
+#define glDrawArrays(mode, first, count) GLStats::drawArrays(mode, first, count)
+#define glDrawElements(mode, count, type, indices) GLStats::drawElements(mode, count, type, indices)
+#endif
+
+#endif // GL_STATS_H
@@ -0,0 +1,200 @@
+#include "Generator.h"
+#include "Profiler.h"
+#include "Utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace Generator {
+
+    namespace {
+        const int HOUSES_PER_STREET = 8;    // ~18 units per plot, houses are 8-14 wide
+        const int ANIMALS_PER_PASTURE = 30;
+        const float MARGIN = 4.0f;          // Kept free at the chunk edges
+
+        enum class ChunkKind { STREET, PASTURE };
+
+        struct ChunkPlan {
+            ChunkKind kind;
+            int houses, villagers, animals;
+        };
+
+        // k-th of n near-equal shares of total
+        int share(int total, int k, int n) {
+            return int((long long)total * (k + 1) / n - (long long)total * k / n);
+        }
+
+        unsigned chunkSeed(unsigned seed, int index) {
+            return seed ^ (unsigned(index) * 2654435761u); // seedRandom mixes it further
+        }
+
+        // 1. Which chunk is what and how much goes where (cheap, done up front
+        // so the workers never need to talk to each other)
+        std::vector<ChunkPlan> plan(const Params& p) {
+            int streets = (p.houses + HOUSES_PER_STREET - 1) / HOUSES_PER_STREET;
+            int pastures = (p.animals + ANIMALS_PER_PASTURE - 1) / ANIMALS_PER_PASTURE;
+            if (streets == 0 && pastures == 0) streets = (p.villagers > 0) ? 1 : 0;
+
+            std::vector<ChunkPlan> chunks;
+            for (int i = 0; i < streets; i++) chunks.push_back(ChunkPlan{ ChunkKind::STREET, share(p.houses, i, streets), 0, 0 });
+            for (int i = 0; i < pastures; i++) chunks.push_back(ChunkPlan{ ChunkKind::PASTURE, 0, 0, share(p.animals, i, pastures) });
+
+            // Shuffle, keeping a street first so the starting view shows houses
+            Utils::seedRandom(p.seed);
+            for (int i = int(chunks.size()) - 1; i > 1; i--) std::swap(chunks[i], chunks[1 + Utils::randomInt(i)]);
+
+            // Villagers live on the streets (anywhere when there are none)
+            int homes = 0;
+            for (const auto& c : chunks) if (c.kind == ChunkKind::STREET || streets == 0) homes++;
+            int k = 0;
+            for (auto& c : chunks) {
+                if (c.kind == ChunkKind::STREET || streets == 0) c.villagers = share(p.villagers, k++, homes);
+            }
+            return chunks;
+        }
+
+        void addDecorations(SceneFile::Layout& out, DecorationType type, int count, float x0, float y0, float y1) {
+            for (int i = 0; i < count; i++) {
+                Decoration d = { type, Utils::random(x0 + MARGIN, x0 + SceneFile::CHUNK_WIDTH - MARGIN), Utils::random(y0, y1) };
+                out.decorations.push_back(d);
+            }
+        }
+
+        // Villagers who keep to the chunk
+        void addVillagers(SceneFile::Layout& out, int count, float x0) {
+            for (int i = 0; i < count; i++) {
+                SceneFile::VillagerSpot v = { Utils::random(x0 + MARGIN, x0 + SceneFile::CHUNK_WIDTH - MARGIN),
+                                              x0 + MARGIN, x0 + SceneFile::CHUNK_WIDTH - MARGIN };
+                out.villagers.push_back(v);
+            }
+        }
+
+        void buildStreet(const ChunkPlan& c, float x0, SceneFile::Layout& out) {
+            // Houses on plots along the street, set back a little at random
+            float plot = (SceneFile::CHUNK_WIDTH - 2 * MARGIN) / float(std::max(c.houses, 1));
+            for (int i = 0; i < c.houses; i++) {
+                float x = x0 + MARGIN + plot * float(i) + Utils::random(0.0f, std::max(0.0f, plot - 14.0f));
+                out.houses.push_back(SceneFile::Spot{ x, Utils::random(17.0f, 23.0f) });
+            }
+
+            // Villagers stay on their street
+            addVillagers(out, c.villagers, x0);
+
+            addDecorations(out, DecorationType::TREE, 2 + Utils::randomInt(3), x0, 20.0f, 20.0f);
+            addDecorations(out, DecorationType::FOLIAGE, 3 + Utils::randomInt(4), x0, 17.0f, 19.0f);
+            addDecorations(out, DecorationType::FLOWERS, 1 + Utils::randomInt(3), x0, 15.0f, 16.0f);
+        }
+
+        void buildPasture(const ChunkPlan& c, float x0, SceneFile::Layout& out) {
+            // Herds of one kind around a spot, every 5th animal a bird over the field
+            float lo = x0 + MARGIN, hi = x0 + SceneFile::CHUNK_WIDTH - MARGIN;
+            int placed = 0;
+            while (placed < c.animals) {
+                int size = std::min(c.animals - placed, 6 + Utils::randomInt(7));
+                AnimalType type = Utils::randomInt(2) ? AnimalType::COW : AnimalType::SHEEP;
+                float center = Utils::random(lo + 15.0f, hi - 15.0f);
+                for (int i = 0; i < size; i++, placed++) {
+                    if (placed % 5 == 4) {
+                        SceneFile::AnimalSpot bird = { AnimalType::BIRD, Utils::random(lo, hi), Utils::random(45.0f, 55.0f), lo, hi };
+                        out.animals.push_back(bird);
+                        continue;
+                    }
+                    float x = center + Utils::random(-8.0f, 8.0f);
+                    SceneFile::AnimalSpot a = { type, x, 20.0f, std::max(lo, center - 25.0f), std::min(hi, center + 25.0f) };
+                    out.animals.push_back(a);
+                }
+            }
+
+            // Villagers only live here in villages without houses
+            addVillagers(out, c.villagers, x0);
+
+            addDecorations(out, DecorationType::TREE, 4 + Utils::randomInt(5), x0, 20.0f, 20.0f);
+            addDecorations(out, DecorationType::FOLIAGE, 3 + Utils::randomInt(4), x0, 17.0f, 19.0f);
+            addDecorations(out, DecorationType::FLOWERS, 6 + Utils::randomInt(7), x0, 14.0f, 17.0f);
+        }
+
+        template <typename T>
+        void append(std::vector<T>& to, const std::vector<T>& from) {
+            to.insert(to.end(), from.begin(), from.end());
+        }
+    }
+
+    void generate(const Params& params, SceneFile::Layout& out) {
+        unsigned long long callerRng = Utils::getRandomState();
+        std::vector<ChunkPlan> chunks = plan(params);
+
+        // 2. Chunks in parallel, each into its own layout
+        std::vector<SceneFile::Layout> parts(chunks.size());
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t i = next.fetch_add(1); i < chunks.size(); i = next.fetch_add(1)) {
+                Utils::seedRandom(chunkSeed(params.seed, int(i)));
+                float x0 = SceneFile::chunkStart(int(i));
+                if (chunks[i].kind == ChunkKind::STREET) buildStreet(chunks[i], x0, parts[i]);
+                else buildPasture(chunks[i], x0, parts[i]);
+            }
+        };
+
+        int threads = params.threads > 0 ? params.threads : int(std::max(1u, std::thread::hardware_concurrency()));
+        threads = std::max(1, std::min(threads, int(chunks.size())));
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+        worker(); // The calling thread takes a share too
+        for (auto& t : pool) t.join();
+        Utils::setRandomState(callerRng);
+
+        // 3. Concatenate in chunk order
+        out = SceneFile::Layout();
+        for (const auto& part : parts) {
+            append(out.houses, part.houses);
+            append(out.villagers, part.villagers);
+            append(out.animals, part.animals);
+            append(out.decorations, part.decorations);
+        }
+        SceneFile::sortIntoChunks(out);
+    }
+
+    bool parseArgs(int argc, char** argv, Params& params) {
+        bool found = false;
+        for (int i = 1; i + 1 < argc; i++) {
+            if (strcmp(argv[i], "--generate") == 0) {
+                params.seed = unsigned(strtoul(argv[i + 1], nullptr, 10));
+                found = true;
+            }
+            else if (strcmp(argv[i], "--houses") == 0) params.houses = std::max(0, atoi(argv[i + 1]));
+            else if (strcmp(argv[i], "--villagers") == 0) params.villagers = std::max(0, atoi(argv[i + 1]));
+            else if (strcmp(argv[i], "--animals") == 0) params.animals = std::max(0, atoi(argv[i + 1]));
+            else if (strcmp(argv[i], "--threads") == 0) params.threads = atoi(argv[i + 1]);
+        }
+        return found;
+    }
+
+    int run(int argc, char** argv) {
+        Params params;
+        const char* outPath = nullptr;
+        parseArgs(argc, argv, params);
+        for (int i = 1; i + 1 < argc; i++) {
+            if (strcmp(argv[i], "--save-scene") == 0) outPath = argv[i + 1];
+        }
+        if (!outPath) {
+            fprintf(stderr, "generate: --save-scene <file> is required\n");
+            return 1;
+        }
+
+        SceneFile::Layout layout;
+        long long startNs = Profiler::nowNs();
+        generate(params, layout);
+        double ms = (Profiler::nowNs() - startNs) / 1e6;
+        printf("Generated village %u: %zu chunks, %zu houses, %zu villagers, %zu animals, %zu decorations in %.1f ms\n",
+               params.seed, layout.chunks.size(), layout.houses.size(), layout.villagers.size(),
+               layout.animals.size(), layout.decorations.size(), ms);
+
+        if (!SceneFile::save(outPath, layout)) return 1;
+        printf("Saved %s\n", outPath);
+        return 0;
+    }
+}
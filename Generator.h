@@ -0,0 +1,34 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "SceneFile.h"
+
+// Procedural villages far beyond the hand-placed one.
+// The village is laid out chunk by chunk along x (SceneFile::CHUNK_WIDTH
+// strips): streets of houses with the villagers living there, and pastures
+// with herds, birds and scenery. Every chunk draws from its own random stream
+// derived from (seed, chunk index) and is built on a worker thread, so the
+// result only depends on the seed and the targets, never on the thread count.
+namespace Generator {
+    struct Params {
+        unsigned seed;
+        int houses;
+        int villagers;
+        int animals;
+        int threads; // 0 = one per core
+
+        Params() : seed(1), houses(10000), villagers(100000), animals(20000), threads(0) {}
+    };
+
+    // Replaces out with a village of exactly the requested counts, sorted into chunks
+    void generate(const Params& params, SceneFile::Layout& out);
+
+    // Reads --generate <seed> and --houses/--villagers/--animals/--threads;
+    // false when --generate is not given
+    bool parseArgs(int argc, char** argv, Params& params);
+
+    // village.exe --generate <seed> --save-scene <file> ...: writes the village as a scene file
+    int run(int argc, char** argv);
+}
+
+#endif // GENERATOR_H
@@ -0,0 +1,306 @@
+#include "Journal.h"
+#include "Profiler.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace Journal {
+
+    namespace {
+        const unsigned MAGIC = 0x4e524a56; // "VJRN"
+        const unsigned VERSION = 2;
+
+        enum RecordType {
+            KEY = 1,
+            RESIZE = 2,
+            CHECKPOINT = 3,
+            END = 4
+        };
+
+        struct Record {
+            long long tick;
+            int type;
+            int a, b; // Key / width, height
+            unsigned long long hash;
+        };
+
+        // --- Recording ---
+        FILE* out = nullptr;
+        long long lastTick = 0; // Ticks are stored as deltas
+        bool exitHookInstalled = false;
+
+        void putVarint(unsigned long long v) {
+            unsigned char buf[10];
+            int n = 0;
+            while (v >= 0x80) {
+                buf[n++] = (unsigned char)(v | 0x80);
+                v >>= 7;
+            }
+            buf[n++] = (unsigned char)v;
+            fwrite(buf, 1, n, out);
+        }
+
+        void putRecord(int type, long long tick) {
+            fputc(type, out);
+            putVarint((unsigned long long)(tick - lastTick));
+            lastTick = tick;
+        }
+
+        void stopRecording() {
+            if (!out) return;
+            long long tick = Scene::getState().tick;
+            unsigned long long h = stateHash();
+            putRecord(END, tick);
+            fwrite(&h, sizeof(h), 1, out);
+            fclose(out);
+            out = nullptr;
+        }
+
+        // --- Replay ---
+        std::vector<Record> records;
+        size_t cursor = 0;
+        bool replaying = false;
+        int checkpointsOk = 0;
+        long long firstDivergence = -1;
+
+        unsigned long long getVarint(const unsigned char*& p, const unsigned char* end) {
+            unsigned long long v = 0;
+            for (int shift = 0; p < end && shift < 64; shift += 7) {
+                unsigned char b = *p++;
+                v |= (unsigned long long)(b & 0x7f) << shift;
+                if (!(b & 0x80)) break;
+            }
+            return v;
+        }
+
+        void verify(const Record& r) {
+            if (r.hash == stateHash()) {
+                checkpointsOk++;
+            } else if (firstDivergence < 0) {
+                firstDivergence = r.tick;
+                fprintf(stderr, "Replay: state diverged at tick %lld\n", r.tick);
+            }
+        }
+
+        void finishReplay() {
+            replaying = false;
+            if (firstDivergence < 0) printf("Replay: identical (%d checkpoints)\n", checkpointsOk);
+            else printf("Replay: DIVERGED at tick %lld (%d checkpoints matched before)\n", firstDivergence, checkpointsOk);
+        }
+
+        void mix(unsigned long long& h, const void* data, size_t n) {
+            const unsigned char* p = (const unsigned char*)data;
+            for (size_t i = 0; i < n; i++) {
+                h ^= p[i];
+                h *= 1099511628211ULL; // FNV-1a
+            }
+        }
+    }
+
+    bool startRecording(const char* path, const Header& h) {
+        if (out) return false;
+        out = fopen(path, "wb");
+        if (!out) return false;
+
+        unsigned header[10] = { MAGIC, VERSION, h.seed,
+                                unsigned(h.world.houses), unsigned(h.world.villagers), unsigned(h.world.animals),
+                                unsigned(h.world.particlePool), unsigned(h.world.emitters),
+                                unsigned(h.width), unsigned(h.height) };
+        fwrite(header, sizeof(header), 1, out);
+        putVarint(h.scene.size());
+        fwrite(h.scene.data(), 1, h.scene.size(), out);
+        lastTick = 0;
+
+        if (!exitHookInstalled) {
+            atexit(stopRecording); // ESC / window close seal the journal with the final hash
+            exitHookInstalled = true;
+        }
+        return true;
+    }
+
+    bool isRecording() {
+        return out != nullptr;
+    }
+
+    void recordKey(long long tick, unsigned char key) {
+        if (!out) return;
+        putRecord(KEY, tick);
+        fputc(key, out);
+    }
+
+    void recordResize(long long tick, int width, int height) {
+        if (!out) return;
+        putRecord(RESIZE, tick);
+        putVarint((unsigned long long)width);
+        putVarint((unsigned long long)height);
+    }
+
+    bool startReplay(const char* path, Header& h) {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        std::vector<unsigned char> bytes;
+        unsigned char buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+        fclose(f);
+
+        unsigned header[10];
+        if (bytes.size() < sizeof(header)) return false;
+        memcpy(header, bytes.data(), sizeof(header));
+        if (header[0] != MAGIC || header[1] != VERSION) return false;
+        h.seed = header[2];
+        h.world.houses = int(header[3]);
+        h.world.villagers = int(header[4]);
+        h.world.animals = int(header[5]);
+        h.world.particlePool = int(header[6]);
+        h.world.emitters = int(header[7]);
+        h.width = int(header[8]);
+        h.height = int(header[9]);
+
+        const unsigned char* p = bytes.data() + sizeof(header);
+        const unsigned char* end = bytes.data() + bytes.size();
+        size_t sceneLength = size_t(getVarint(p, end));
+        if (sceneLength > size_t(end - p)) return false;
+        h.scene.assign((const char*)p, sceneLength);
+        p += sceneLength;
+
+        // Decode every record up front (journals are small)
+        records.clear();
+        long long tick = 0;
+        while (p < end) {
+            Record r = Record();
+            r.type = *p++;
+            tick += (long long)getVarint(p, end);
+            r.tick = tick;
+            if (r.type == KEY && p < end) {
+                r.a = *p++;
+            } else if (r.type == RESIZE) {
+                r.a = int(getVarint(p, end));
+                r.b = int(getVarint(p, end));
+            } else if ((r.type == CHECKPOINT || r.type == END) && end - p >= 8) {
+                memcpy(&r.hash, p, 8);
+                p += 8;
+            } else {
+                break; // Truncated tail (crash while recording)
+            }
+            records.push_back(r);
+        }
+
+        cursor = 0;
+        checkpointsOk = 0;
+        firstDivergence = -1;
+        replaying = true;
+        return true;
+    }
+
+    bool isReplaying() {
+        return replaying;
+    }
+
+    void applyDue(long long tick) {
+        while (replaying && cursor < records.size() && records[cursor].tick == tick) {
+            const Record& r = records[cursor++];
+            if (r.type == KEY) {
+                if (r.a != 27) Scene::applyKey((unsigned char)r.a); // ESC ends the journal instead
+                tick = Scene::getState().tick; // Skip-ahead keys move the clock, later inputs were recorded after it
+            } else if (r.type == RESIZE) {
+                Scene::resize(r.a, r.b);
+            } else if (r.type == END) {
+                verify(r);
+                finishReplay();
+            }
+        }
+    }
+
+    void afterTick(long long tick) {
+        if (out && tick % CHECKPOINT_TICKS == 0) {
+            unsigned long long h = stateHash();
+            putRecord(CHECKPOINT, tick);
+            fwrite(&h, sizeof(h), 1, out);
+            fflush(out); // A crash keeps everything up to the last checkpoint
+        }
+        while (replaying && cursor < records.size() && records[cursor].tick == tick && records[cursor].type == CHECKPOINT) {
+            verify(records[cursor++]);
+        }
+    }
+
+    unsigned long long stateHash() {
+        Dormancy::settle(Scene::getState()); // Hash what a tick-by-tick run would hold
+        const Scene::State& s = Scene::getState();
+        unsigned long long h = 14695981039346656037ULL;
+        unsigned long long rng = Utils::getRandomState();
+        mix(h, &rng, sizeof(rng));
+        mix(h, &s.tick, sizeof(s.tick));
+        mix(h, &s.timeOfDay, sizeof(s.timeOfDay));
+        mix(h, &s.currentSeason, sizeof(s.currentSeason));
+
+        // Characters and animals have no padding, hash the arrays whole
+        mix(h, s.villagers.data(), s.villagers.size() * sizeof(Character));
+        mix(h, s.animals.data(), s.animals.size() * sizeof(Animal));
+        for (const auto& b : s.houses) {
+            mix(h, &b.lightOn, sizeof(b.lightOn));
+            mix(h, &b.doorAngle, sizeof(b.doorAngle));
+        }
+
+        mix(h, &s.weather.currentType, sizeof(s.weather.currentType));
+        mix(h, &s.weather.windStrength, sizeof(s.weather.windStrength));
+        mix(h, &s.weather.lightningTimer, sizeof(s.weather.lightningTimer));
+        for (const auto& p : s.weather.particles) {
+            if (!p.active) continue;
+            mix(h, &p.x, sizeof(p.x));
+            mix(h, &p.y, sizeof(p.y));
+        }
+        for (const auto& p : s.particles.pool) {
+            if (!p.active) continue;
+            mix(h, &p.x, sizeof(p.x));
+            mix(h, &p.y, sizeof(p.y));
+        }
+
+        mix(h, &s.events.currentEvent, sizeof(s.events.currentEvent));
+        mix(h, &s.events.eventTimer, sizeof(s.events.eventTimer));
+        mix(h, &s.camera.x, sizeof(s.camera.x));
+        return h;
+    }
+
+    int runHeadless(const char* path) {
+        Header h;
+        if (!startReplay(path, h)) {
+            fprintf(stderr, "Replay: cannot read %s\n", path);
+            return 1;
+        }
+
+        // Same seed, same world, same window size as the recording
+        static SceneFile::Layout layout;
+        if (!h.scene.empty()) {
+            if (!SceneFile::load(h.scene.c_str(), layout)) return 1;
+            h.world.layout = &layout;
+        }
+        Utils::seedRandom(h.seed);
+        Scene::buildWorld(h.world, true); // Streamed like the recorded window
+        Scene::resize(h.width, h.height);
+
+        Scene::State& state = Scene::getState();
+        long long startNs = Profiler::nowNs();
+        applyDue(state.tick);
+        while (replaying && cursor < records.size()) {
+            Scene::tick();
+            Profiler::endFrame();
+            applyDue(state.tick);
+        }
+        double seconds = (Profiler::nowNs() - startNs) * 1e-9;
+
+        if (replaying) {
+            fprintf(stderr, "Replay: journal has no end record (recording crashed?), stopped at tick %lld\n", state.tick);
+            finishReplay();
+        }
+        printf("%lld ticks in %.3f s (%.0f ticks/s)\n", state.tick, seconds, seconds > 0 ? state.tick / seconds : 0.0);
+
+        std::vector<Profiler::StageStats> stages;
+        Profiler::getStats(stages);
+        for (const auto& st : stages) {
+            if (st.depth == 1 && st.totalMs > 0.0) printf("  %-12s %10.1f ms\n", st.name, st.totalMs);
+        }
+        return firstDivergence < 0 ? 0 : 1;
+    }
+}
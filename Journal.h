@@ -0,0 +1,44 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "Scene.h"
+#include <string>
+
+// Deterministic record/replay.
+// A journal holds the RNG seed and starting world, then every input that can
+// change the simulation (keys, window resizes) stamped with the tick it arrived
+// after, plus a state hash every CHECKPOINT_TICKS ticks. Replaying seeds the
+// same generator, rebuilds the same world and feeds the inputs back at the same
+// ticks; the checkpoints show exactly where a run diverges.
+namespace Journal {
+    const int CHECKPOINT_TICKS = 600;
+
+    struct Header {
+        unsigned seed;
+        Scene::WorldConfig world; // Sizes only; the layout is named by scene
+        int width, height;
+        std::string scene; // Scene description file ("" = built-in village)
+    };
+
+    // Recording
+    bool startRecording(const char* path, const Header& h);
+    bool isRecording();
+    void recordKey(long long tick, unsigned char key);
+    void recordResize(long long tick, int width, int height);
+
+    // Replay (window or headless)
+    bool startReplay(const char* path, Header& h);
+    bool isReplaying();
+    void applyDue(long long tick); // Inputs that arrived after this tick (call before the next one)
+
+    // Scene::tick calls this after every tick (writes or verifies checkpoints)
+    void afterTick(long long tick);
+
+    // Hash over the simulated state (entities, particles, weather, time, RNG)
+    unsigned long long stateHash();
+
+    // village.exe --replay <file> --headless: replays at full speed and reports
+    int runHeadless(const char* path);
+}
+
+#endif // JOURNAL_H
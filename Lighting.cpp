@@ -1,45 +1,149 @@
 #include "Lighting.h"
 #include <GL/glut.h>
 #include <cmath>
+#include <algorithm>
 #include <iostream>
 
 namespace LightingSystem {
 
-    void collectLights(std::vector<LightSource>& lights, float timeOfDay, 
-                       const std::vector<float>& houseX, const std::vector<float>& houseY) {
-        // Collect house window lights (only at night - 18:00 to 06:00)
+    LightHandle registerLight(LightRegistry& reg, const LightSource& light) {
+        LightHandle h;
+        if (!reg.freeSlots.empty()) {
+            h = reg.freeSlots.back();
+            reg.freeSlots.pop_back();
+        } else {
+            h = LightHandle(reg.lights.size());
+            reg.lights.push_back(LightSource());
+        }
+        
+        LightSource& l = reg.lights[h];
+        l = light;
+        l.inUse = true;
+        // Night-only lights follow the current schedule from the start
+        if (l.nightOnly && reg.scheduleKnown) l.active = reg.isNight;
+        if (l.active) reg.activeCount++;
+        
+        reg.revision++;
+        return h;
+    }
+    
+    void unregisterLight(LightRegistry& reg, LightHandle handle) {
+        if (handle < 0 || handle >= int(reg.lights.size()) || !reg.lights[handle].inUse) return;
+        if (reg.lights[handle].active) reg.activeCount--;
+        reg.lights[handle].inUse = false;
+        reg.lights[handle].active = false;
+        reg.freeSlots.push_back(handle);
+        reg.revision++;
+    }
+    
+    void setLightActive(LightRegistry& reg, LightHandle handle, bool active) {
+        if (handle < 0 || handle >= int(reg.lights.size())) return;
+        LightSource& l = reg.lights[handle];
+        if (!l.inUse || l.active == active) return;
+        l.active = active;
+        reg.activeCount += active ? 1 : -1;
+        reg.revision++;
+    }
+    
+    void moveLight(LightRegistry& reg, LightHandle handle, float x, float y) {
+        if (handle < 0 || handle >= int(reg.lights.size())) return;
+        LightSource& l = reg.lights[handle];
+        if (!l.inUse || (l.x == x && l.y == y)) return;
+        l.x = x; l.y = y;
+        reg.revision++;
+    }
+    
+    void updateSchedule(LightRegistry& reg, float timeOfDay) {
+        // House window lights (only at night - 18:00 to 06:00)
         bool isNight = (timeOfDay < 6.0f || timeOfDay > 18.0f);
+        if (reg.scheduleKnown && reg.isNight == isNight) return;
         
-        lights.clear();
-        
-        if (isNight) {
-            for (size_t i = 0; i < houseX.size(); ++i) {
-                // Window light 1
-                LightSource l1;
-                l1.x = houseX[i] + 2; l1.y = houseY[i] + 6.5f;
-                l1.radius = 8.0f;
-                l1.color = Utils::Color(1.0f, 0.9f, 0.4f, 0.8f); // Warm yellow
-                l1.active = true;
-                lights.push_back(l1);
-                
-                // Window light 2
-                LightSource l2;
-                l2.x = houseX[i] + 10; l2.y = houseY[i] + 6.5f;
-                l2.radius = 8.0f;
-                l2.color = Utils::Color(1.0f, 0.9f, 0.4f, 0.8f);
-                l2.active = true;
-                lights.push_back(l2);
+        reg.isNight = isNight;
+        reg.scheduleKnown = true;
+        for (auto& l : reg.lights) {
+            if (!l.inUse || !l.nightOnly || l.active == isNight) continue;
+            l.active = isNight;
+            reg.activeCount += isNight ? 1 : -1;
+        }
+        reg.revision++;
+    }
+
+    // --- Lightmap ---
+    // Coarse vertex grid over the world region the camera can reach. Lights are
+    // splatted into it on the CPU and the whole grid is composited in one draw;
+    // Gouraud interpolation between grid vertices does the upsampling.
+    namespace {
+        const int LM_COLS = 70;
+        const int LM_ROWS = 50;
+        const float LM_X0 = -40.0f;
+        const float LM_Y0 = -20.0f;
+        const float LM_CELL = 2.0f;
+        const int LM_VERTS = (LM_COLS + 1) * (LM_ROWS + 1);
+
+        MemoryTracker::Vector<GLfloat, MemoryTracker::RENDER> lmPositions; // xy per vertex, built once
+        MemoryTracker::Vector<GLuint, MemoryTracker::RENDER> lmIndices;    // two triangles per cell, built once
+        MemoryTracker::Vector<GLfloat, MemoryTracker::RENDER> lmLight;     // rgb accumulation per vertex
+        MemoryTracker::Vector<GLfloat, MemoryTracker::RENDER> lmColors;    // final premultiplied rgba per vertex
+
+        // Light accumulation only changes when the registry does
+        unsigned lmRevision = 0;
+        bool lmLightsVisible = false;
+        float lmOffsetX = 0.0f;
+        bool lmValid = false;
+
+        void buildLightmapGrid() {
+            lmPositions.resize(LM_VERTS * 2);
+            for (int row = 0; row <= LM_ROWS; ++row) {
+                for (int col = 0; col <= LM_COLS; ++col) {
+                    int v = row * (LM_COLS + 1) + col;
+                    lmPositions[v * 2] = LM_X0 + col * LM_CELL;
+                    lmPositions[v * 2 + 1] = LM_Y0 + row * LM_CELL;
+                }
             }
             
-            // Random ambient fireflies?
-            // Static for now, but could be dynamic
+            lmIndices.reserve(LM_COLS * LM_ROWS * 6);
+            for (int row = 0; row < LM_ROWS; ++row) {
+                for (int col = 0; col < LM_COLS; ++col) {
+                    GLuint v = row * (LM_COLS + 1) + col;
+                    GLuint up = v + (LM_COLS + 1);
+                    lmIndices.push_back(v); lmIndices.push_back(v + 1); lmIndices.push_back(up + 1);
+                    lmIndices.push_back(v); lmIndices.push_back(up + 1); lmIndices.push_back(up);
+                }
+            }
+            
+            lmLight.resize(LM_VERTS * 3);
+            lmColors.resize(LM_VERTS * 4);
+        }
+
+        // Adds a radial light to the grid. Falloff is (1 - d/r)^2, which is what the
+        // old additive fans produced (color and alpha both fading to zero at the rim).
+        void splatLight(float x, float y, float radius, const Utils::Color& c, float alpha) {
+            int col0 = std::max(0, int(floor((x - radius - LM_X0) / LM_CELL)));
+            int col1 = std::min(LM_COLS, int(ceil((x + radius - LM_X0) / LM_CELL)));
+            int row0 = std::max(0, int(floor((y - radius - LM_Y0) / LM_CELL)));
+            int row1 = std::min(LM_ROWS, int(ceil((y + radius - LM_Y0) / LM_CELL)));
+            
+            float r2 = radius * radius;
+            float invR = 1.0f / radius;
+            for (int row = row0; row <= row1; ++row) {
+                float dy = LM_Y0 + row * LM_CELL - y;
+                for (int col = col0; col <= col1; ++col) {
+                    float dx = LM_X0 + col * LM_CELL - x;
+                    float d2 = dx * dx + dy * dy;
+                    if (d2 >= r2) continue;
+                    
+                    float t = 1.0f - sqrtf(d2) * invR;
+                    float f = t * t * alpha;
+                    GLfloat* L = &lmLight[(row * (LM_COLS + 1) + col) * 3];
+                    L[0] += c.r * f;
+                    L[1] += c.g * f;
+                    L[2] += c.b * f;
+                }
+            }
         }
     }
 
-    void drawLightingOverlay(int width, int height, float timeOfDay, 
-                             const Utils::Color& ambientLight, 
-                             const std::vector<LightSource>& lights) {
-                             
+    float getDarkness(float timeOfDay) {
         // Darkness Factor: How dark is the overlay?
         // 0.0 = Full Day, 0.7 = Full Night
         float darkness = 0.0f;
@@ -57,54 +161,63 @@ namespace LightingSystem {
              darkness = (1.0f - (timeOfDay - 5.0f) / 2.0f) * 0.7f;
         }
         
-        if (darkness <= 0.05f) return; // Almost day, no overlay
+        if (darkness <= 0.05f) return 0.0f; // Almost day, no overlay
+        return darkness;
+    }
+
+    void drawLightmap(float timeOfDay, const LightRegistry& reg, float offsetX) {
+        float darkness = getDarkness(timeOfDay);
         
-        // We need blending: DEST * SRC (Multiplicative) or similar?
-        // Standard approach for 2D lighting: Draw full screen dark quad, 
-        // subtract/punch holes using alpha channel, or use specialized blending.
-        // Simple approach: Draw dark quad with holes? No, hard in fixed pipeline.
-        // Alternative: Draw full dark quad with transparency, then draw light sprites on top 
-        // with Additive Blending to "brighten" the area.
+        if (darkness <= 0.0f && reg.activeCount == 0) return;
         
-        // 1. Draw Darkness (Multiply or Alpha Subtraction)
-        // With standard glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), drawing black @ 0.7 alpha darkens everything.
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        if (lmPositions.empty()) buildLightmapGrid();
         
-        // Base Darkness Color (Dark Blue/Purple Night)
-        glColor4f(0.0f, 0.05f, 0.15f, darkness); 
+        // 1. Accumulate lights (only when it is dark enough to see them) and bloom.
+        //    Skipped entirely while the registry is unchanged.
+        bool lightsVisible = darkness > 0.0f;
+        if (!lmValid || lmRevision != reg.revision || lmLightsVisible != lightsVisible || lmOffsetX != offsetX) {
+            std::fill(lmLight.begin(), lmLight.end(), 0.0f);
+            for (const auto& l : reg.lights) {
+                if (!l.active) continue;
+                if (lightsVisible) splatLight(l.x - offsetX, l.y, l.radius, l.color, l.color.a * 0.8f);
+                splatLight(l.x - offsetX, l.y, l.radius * 2.5f, l.color, 0.15f); // Bloom
+            }
+            lmRevision = reg.revision;
+            lmLightsVisible = lightsVisible;
+            lmOffsetX = offsetX;
+            lmValid = true;
+        }
         
-        glBegin(GL_QUADS);
-        glVertex2f(-100, -100);
-        glVertex2f(width + 100, -100);
-        glVertex2f(width + 100, height + 100);
-        glVertex2f(-100, height + 100);
-        glEnd();
+        // 2. Resolve: darkness tint plus light, premultiplied so a single
+        //    (ONE, ONE_MINUS_SRC_ALPHA) blend both darkens and brightens
+        const Utils::Color night(0.0f, 0.05f, 0.15f); // Dark Blue/Purple Night
+        for (int v = 0; v < LM_VERTS; ++v) {
+            const GLfloat* L = &lmLight[v * 3];
+            GLfloat* C = &lmColors[v * 4];
+            C[0] = std::min(1.0f, night.r * darkness + L[0]);
+            C[1] = std::min(1.0f, night.g * darkness + L[1]);
+            C[2] = std::min(1.0f, night.b * darkness + L[2]);
+            C[3] = darkness;
+        }
         
-        // 2. Draw Lights (Additive Blending) to cancel out darkness and add glow
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive
+        // 3. Composite
+        glPushAttrib(GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
         
-        for (const auto& l : lights) {
-            if (!l.active) continue;
-            
-            // Draw radial gradient (center opaque, edge transparent)
-            glBegin(GL_TRIANGLE_FAN);
-            glColor4f(l.color.r, l.color.g, l.color.b, l.color.a * 0.8f); // Center
-            glVertex2f(l.x, l.y);
-            
-            glColor4f(0.0f, 0.0f, 0.0f, 0.0f); // Edge (Black adds nothing)
-            int segments = 20;
-            for (int i = 0; i <= segments; ++i) {
-                float theta = 2.0f * 3.14159f * float(i) / float(segments);
-                float dx = l.radius * cos(theta);
-                float dy = l.radius * sin(theta);
-                glVertex2f(l.x + dx, l.y + dy);
-            }
-            glEnd();
-        }
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
         
-        glDisable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Reset
+        glPushMatrix();
+        glTranslatef(offsetX, 0.0f, 0.0f);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, 0, lmPositions.data());
+        glColorPointer(4, GL_FLOAT, 0, lmColors.data());
+        glDrawElements(GL_TRIANGLES, GLsizei(lmIndices.size()), GL_UNSIGNED_INT, lmIndices.data());
+        glPopMatrix();
+        
+        glPopClientAttrib();
+        glPopAttrib();
     }
     
     void drawGodRays(int width, int height, float timeOfDay) {
@@ -158,23 +271,5 @@ namespace LightingSystem {
         glDisable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     }
-    
-    void drawBloom(const std::vector<LightSource>& lights) {
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE); 
-        for (const auto& l : lights) {
-            if (!l.active) continue;
-            glBegin(GL_TRIANGLE_FAN);
-            glColor4f(l.color.r, l.color.g, l.color.b, 0.15f);
-            glVertex2f(l.x, l.y);
-            glColor4f(0, 0, 0, 0);
-            for(int i=0; i<=16; i++) {
-                float a = 2.0f * 3.14159f * i / 16;
-                glVertex2f(l.x + cos(a) * l.radius * 2.5f, l.y + sin(a) * l.radius * 2.5f);
-            }
-            glEnd();
-        }
-        glDisable(GL_BLEND);
-    }
 
 }
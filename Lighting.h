@@ -2,6 +2,7 @@
 #define LIGHTING_H
 
 #include "Utils.h"
+#include "Memory.h"
 #include <vector>
 
 struct LightSource {
@@ -10,23 +11,50 @@ struct LightSource {
     Utils::Color color;
     float flickerOffset;
     bool active; // Day vs Night logic
+    bool nightOnly; // Switched by the day/night schedule
+    bool inUse; // Registry slot is occupied
+};
+
+// Handle into the light registry (slot index)
+typedef int LightHandle;
+const LightHandle INVALID_LIGHT = -1;
+
+// Persistent set of lights. Owners register once and keep the handle;
+// only state transitions touch the registry after that.
+struct LightRegistry {
+    MemoryTracker::Vector<LightSource, MemoryTracker::LIGHTS> lights; // Slots, freed ones are reused
+    MemoryTracker::Vector<LightHandle, MemoryTracker::LIGHTS> freeSlots;
+    
+    int activeCount;
+    bool isNight; // Last schedule state applied
+    bool scheduleKnown;
+    unsigned revision; // Dirty counter, bumped on every change
+    
+    LightRegistry() : activeCount(0), isNight(false), scheduleKnown(false), revision(0) {}
 };
 
 namespace LightingSystem {
-    // Collects all active lights (street lamps, windows, fireflies?)
-    void collectLights(std::vector<LightSource>& lights, float timeOfDay, 
-                       const std::vector<float>& houseX, const std::vector<float>& houseY);
-
-    // Renders the dark overlay with punch-outs for lights (Multiplicative blending)
-    void drawLightingOverlay(int width, int height, float timeOfDay, 
-                             const Utils::Color& ambientLight, 
-                             const std::vector<LightSource>& lights);
+    // Registry
+    LightHandle registerLight(LightRegistry& reg, const LightSource& light);
+    void unregisterLight(LightRegistry& reg, LightHandle handle);
+    void setLightActive(LightRegistry& reg, LightHandle handle, bool active);
+    void moveLight(LightRegistry& reg, LightHandle handle, float x, float y);
+    
+    // Switches night-only lights at the dusk/dawn transitions (18:00 - 06:00).
+    // Does nothing on ticks without a transition.
+    void updateSchedule(LightRegistry& reg, float timeOfDay);
+
+    // Overlay darkness for the time of day (0.0 = full day, 0.7 = full night)
+    float getDarkness(float timeOfDay);
+
+    // Accumulates all lights (and their bloom) into a coarse CPU lightmap and
+    // composites darkness + light + bloom in a single draw.
+    // The accumulation is cached and only redone when reg.revision changes.
+    // offsetX slides the grid along x (CameraSystem::backdropOffset).
+    void drawLightmap(float timeOfDay, const LightRegistry& reg, float offsetX = 0.0f);
                              
     // Renders volumetric light shafts (Additive blending) during sunrise/sunset
     void drawGodRays(int width, int height, float timeOfDay);
-    
-    // Renders simple bloom/glow sprites over bright spots
-    void drawBloom(const std::vector<LightSource>& lights);
 }
 
 #endif // LIGHTING_H
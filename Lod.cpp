@@ -0,0 +1,45 @@
+#include "Lod.h"
+#include "Scene.h"
+#include <algorithm>
+#include <cfloat>
+
+namespace Lod {
+
+    Frame frame(const CameraSystem::CameraState& cam, long long tick) {
+        Frame f;
+        CameraSystem::visibleRange(cam, f.viewMin, f.viewMax);
+        f.viewMin -= MARGIN;
+        f.viewMax += MARGIN;
+        f.tick = tick;
+        f.stride = STRIDE;
+        return f;
+    }
+
+    void catchUp(Scene::State& state, size_t firstVillager, size_t firstAnimal, long long elapsed) {
+        long long span = std::min(elapsed, (long long)MIX_TICKS);
+        if (span <= 0) return;
+
+        // 1. The chunk's villagers on their own (partners are found among them), all off-screen
+        CharacterList villagers(state.villagers.begin() + firstVillager, state.villagers.end());
+        float speedMod = WeatherSystem::walkSpeedMod(state.weather);
+        Frame away = { FLT_MAX, -FLT_MAX, 0, CATCH_UP_STEP };
+
+        // 2. Up to now, each tick at the time of day it stands for (weather as it is now)
+        for (long long t = 0; t < span; t++) {
+            float time = state.timeOfDay - float(span - 1 - t) * state.timeSpeed;
+            if (time < 0.0f) time += 24.0f;
+            away.tick = t;
+            CharacterSystem::updateAll(villagers, time, speedMod, &away);
+
+            // Animals never meet, whole steps at a time
+            if ((t + 1) % CATCH_UP_STEP != 0 && t + 1 != span) continue;
+            int ticks = int(t % CATCH_UP_STEP) + 1;
+            bool isNight = (time < 6.0f || time > 19.0f);
+            for (size_t i = firstAnimal; i < state.animals.size(); i++) {
+                AnimalSystem::update(state.animals[i], time, isNight, state.currentWindSway, ticks);
+            }
+        }
+
+        std::copy(villagers.begin(), villagers.end(), state.villagers.begin() + firstVillager);
+    }
+}
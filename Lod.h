@@ -0,0 +1,59 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include <cstddef>
+#include "Camera.h"
+
+namespace Scene { struct State; }
+
+// Level-of-detail tiers for villagers and animals (worlds with State::lod set).
+// 1. Visible (inside the view plus a margin): the usual update every tick.
+// 2. Off-screen but live: every STRIDE ticks, STRIDE ticks at once (timers
+//    run down STRIDE times as far, animals walk STRIDE steps stopping at the
+//    target). The updates are spread over the stride by index so each tick
+//    does 1/STRIDE of them. Walking villagers stay at the full rate: a walk
+//    in a crowd lasts a few ticks before someone stops to talk, and a coarse
+//    step would skew how often that happens.
+// 3. Distant (chunks WorldStream has stored): nothing at all while away. When
+//    the chunk comes back its entities are caught up on the time they missed
+//    as an off-screen chunk with a CATCH_UP_STEP stride, so what the camera
+//    finds looks like a chunk that kept running; decisions are memoryless,
+//    so only the last MIX_TICKS matter.
+// All tiers draw from the same decision rules and a long step carries over
+// how far it ran past a timer, so activity shares match.
+namespace Lod {
+    const int STRIDE = 4;
+    const float MARGIN = 10.0f;      // Beyond the view edges, so nothing changes pace in sight
+    const int MIX_TICKS = 600;       // Catch-up horizon (several decisions per entity)
+    const int CATCH_UP_STEP = 8;     // Stride while catching up
+
+    // What one tick of a world needs to pick tiers
+    struct Frame {
+        float viewMin, viewMax;
+        long long tick;
+        int stride;
+    };
+
+    Frame frame(const CameraSystem::CameraState& cam, long long tick);
+
+    // Ticks the entity at x (index-th in its list) advances this tick: 1 in
+    // view, the stride when its reduced update is due, else 0
+    inline int ticksFor(const Frame& frame, float x, size_t index) {
+        if (x >= frame.viewMin && x <= frame.viewMax) return 1;
+        // Entering the view mid-stride drops the ticks since the last reduced update (< stride)
+        return ((frame.tick + (long long)index) % frame.stride == 0) ? frame.stride : 0;
+    }
+
+    // Of the ticks the next reduced update of that entity will advance, how
+    // many it has already been through at the full rate (0 in view)
+    inline int coveredTicks(const Frame& frame, float x, size_t index) {
+        if (x >= frame.viewMin && x <= frame.viewMax) return 0;
+        return int((frame.tick + (long long)index) % frame.stride);
+    }
+
+    // Distant tier: the villagers and animals from the given indices on were
+    // away (stored or not built yet) for elapsed ticks
+    void catchUp(Scene::State& state, size_t firstVillager, size_t firstAnimal, long long elapsed);
+}
+
+#endif // LOD_H
@@ -0,0 +1,93 @@
+#include "Memory.h"
+#include <atomic>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace MemoryTracker {
+
+    namespace {
+        // Relaxed atomics: containers may live on worker threads (batch runs)
+        struct Counters {
+            std::atomic<long long> live;
+            std::atomic<long long> peak;
+            std::atomic<long long> allocs;
+            std::atomic<long long> allocsAtTickStart;
+            long long tickAllocs; // Written by endTick only
+        };
+
+        Counters counters[TAG_COUNT];
+
+        const char* names[TAG_COUNT] = {
+            "Houses", "Villagers", "Animals", "Lights",
+            "Weather", "Particles", "Analytics", "Scenery", "Streaming", "Render"
+        };
+    }
+
+    void recordAlloc(int tag, size_t bytes) {
+        Counters& c = counters[tag];
+        long long live = c.live.fetch_add((long long)bytes, std::memory_order_relaxed) + (long long)bytes;
+        long long peak = c.peak.load(std::memory_order_relaxed);
+        while (live > peak && !c.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+        c.allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void recordFree(int tag, size_t bytes) {
+        counters[tag].live.fetch_sub((long long)bytes, std::memory_order_relaxed);
+    }
+
+    void endTick() {
+        for (auto& c : counters) {
+            long long now = c.allocs.load(std::memory_order_relaxed);
+            c.tickAllocs = now - c.allocsAtTickStart.load(std::memory_order_relaxed);
+            c.allocsAtTickStart.store(now, std::memory_order_relaxed);
+        }
+    }
+
+    TagStats getStats(int tag) {
+        const Counters& c = counters[tag];
+        TagStats s;
+        s.liveBytes = c.live.load(std::memory_order_relaxed);
+        s.peakBytes = c.peak.load(std::memory_order_relaxed);
+        s.allocCount = c.allocs.load(std::memory_order_relaxed);
+        s.tickAllocs = c.tickAllocs;
+        return s;
+    }
+
+    const char* tagName(int tag) {
+        return (tag >= 0 && tag < TAG_COUNT) ? names[tag] : "?";
+    }
+
+    long long totalLiveBytes() {
+        long long total = 0;
+        for (const auto& c : counters) total += c.live.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    long long totalPeakBytes() {
+        long long total = 0;
+        for (const auto& c : counters) total += c.peak.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    long long processRSS() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS pmc;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return (long long)pmc.WorkingSetSize;
+        return 0;
+#else
+        // /proc/self/statm: size resident ... (in pages)
+        long long pages = 0, resident = 0;
+        FILE* f = fopen("/proc/self/statm", "r");
+        if (!f) return 0;
+        if (fscanf(f, "%lld %lld", &pages, &resident) != 2) resident = 0;
+        fclose(f);
+        return resident * sysconf(_SC_PAGESIZE);
+#endif
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// Allocation accounting per subsystem.
+// Containers owned by the simulation use MemoryTracker::Vector<T, Tag>, whose
+// allocator reports every allocation and free against its tag.
+namespace MemoryTracker {
+    enum Tag {
+        HOUSES,
+        VILLAGERS,
+        ANIMALS,
+        LIGHTS,
+        WEATHER,
+        PARTICLES,
+        ANALYTICS,
+        SCENERY, // Trees, foliage, flowers
+        STREAMING, // Chunks on their way to or from the spill file
+        RENDER, // Per-frame draw batches (shadows, lightmap, heatmap, text)
+        TAG_COUNT
+    };
+
+    struct TagStats {
+        long long liveBytes;
+        long long peakBytes;
+        long long allocCount; // Lifetime
+        long long tickAllocs; // Allocations during the last completed tick
+    };
+
+    void recordAlloc(int tag, size_t bytes);
+    void recordFree(int tag, size_t bytes);
+
+    // Closes the current tick's allocation counts (call once per Scene::update)
+    void endTick();
+
+    TagStats getStats(int tag);
+    const char* tagName(int tag);
+    long long totalLiveBytes();
+    long long totalPeakBytes();
+
+    // Resident set size of the whole process (0 if unavailable)
+    long long processRSS();
+
+    template <class T, int TagId>
+    struct Allocator {
+        typedef T value_type;
+
+        template <class U>
+        struct rebind { typedef Allocator<U, TagId> other; };
+
+        Allocator() {}
+        template <class U>
+        Allocator(const Allocator<U, TagId>&) {}
+
+        T* allocate(size_t n) {
+            recordAlloc(TagId, n * sizeof(T));
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, size_t n) {
+            recordFree(TagId, n * sizeof(T));
+            ::operator delete(p);
+        }
+    };
+
+    template <class T, class U, int TagId>
+    bool operator==(const Allocator<T, TagId>&, const Allocator<U, TagId>&) { return true; }
+    template <class T, class U, int TagId>
+    bool operator!=(const Allocator<T, TagId>&, const Allocator<U, TagId>&) { return false; }
+
+    template <class T, int TagId>
+    using Vector = std::vector<T, Allocator<T, TagId>>;
+}
+
+#endif // MEMORY_H
@@ -0,0 +1,173 @@
+#include "Microbench.h"
+#include "Utils.h"
+#include "Style.h"
+#include "Weather.h"
+#include "Particles.h"
+#include "Character.h"
+#include "Profiler.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Microbench {
+
+    namespace {
+        const char* filter = nullptr;
+        double minSeconds = 0.2;
+        volatile float sink; // Keeps results alive so the optimizer cannot drop the work
+
+        // Runs fn in doubling batches until minSeconds have elapsed (or maxOps ops ran)
+        template <typename Fn>
+        void measure(const char* name, const char* size, double itemsPerOp, long long maxOps, Fn fn) {
+            if (filter && !strstr(name, filter)) return;
+
+            long long ops = 0;
+            long long batch = 1;
+            long long totalNs = 0;
+            while (totalNs < minSeconds * 1e9 && ops < maxOps) {
+                if (ops + batch > maxOps) batch = maxOps - ops;
+                long long startNs = Profiler::nowNs();
+                for (long long i = 0; i < batch; i++) fn();
+                totalNs += Profiler::nowNs() - startNs;
+                ops += batch;
+                batch *= 2;
+            }
+
+            double nsPerOp = double(totalNs) / ops;
+            double itemsPerSec = (totalNs > 0) ? itemsPerOp * ops / (totalNs * 1e-9) : 0.0;
+            printf("%-28s %-14s %12.1f ns/op %14.0f items/s  (%lld ops)\n", name, size, nsPerOp, itemsPerSec, ops);
+        }
+
+        const long long UNLIMITED = 1LL << 40;
+
+        void benchUtils() {
+            // 1. Circle tessellation (50 segments is the default everything draws with)
+            const int segments[3] = { 12, 50, 100 };
+            for (int s : segments) {
+                char size[32];
+                snprintf(size, sizeof(size), "%d segs", s);
+                float x = 0.0f;
+                measure("Utils::drawCircle", size, s, UNLIMITED, [&] {
+                    Utils::drawCircle(2.0f, x, 10.0f, s, true);
+                    x += 0.001f;
+                });
+            }
+
+            // 2. Color lerp over a sky gradient sized batch
+            const int N = 1024;
+            Utils::Color a(0.1f, 0.2f, 0.5f), b(1.0f, 0.6f, 0.3f, 0.5f);
+            measure("Utils::Color::lerp", "1024 colors", N, UNLIMITED, [&] {
+                float acc = 0.0f;
+                for (int i = 0; i < N; i++) acc += Utils::Color::lerp(a, b, float(i) * (1.0f / N)).g;
+                sink = acc;
+            });
+
+            // 3. RNG
+            measure("Utils::random", "1024 draws", N, UNLIMITED, [&] {
+                float acc = 0.0f;
+                for (int i = 0; i < N; i++) acc += Utils::random(-1.0f, 1.0f);
+                sink = acc;
+            });
+        }
+
+        void benchStyle() {
+            const int N = 1024;
+            Utils::Color base(0.4f, 0.6f, 0.3f);
+            measure("Style::applyAtmosphere", "1024 colors", N, UNLIMITED, [&] {
+                float acc = 0.0f;
+                for (int i = 0; i < N; i++) acc += Style::applyAtmosphere(base, float(i) * (24.0f / N), 0.5f).r;
+                sink = acc;
+            });
+
+            Utils::Color spring(0.3f, 0.8f, 0.3f), summer(0.2f, 0.6f, 0.2f), autumn(0.8f, 0.5f, 0.1f), winter(0.9f, 0.9f, 1.0f);
+            measure("Style::getSeasonalColor", "1024 colors", N, UNLIMITED, [&] {
+                float acc = 0.0f;
+                for (int i = 0; i < N; i++) acc += Style::getSeasonalColor((Utils::Season)(i & 3), spring, summer, autumn, winter).g;
+                sink = acc;
+            });
+        }
+
+        void benchWeather() {
+            const int N = 1024;
+            const WeatherType types[2] = { WeatherType::CLEAR, WeatherType::STORM };
+            const char* typeNames[2] = { "clear x1024", "storm x1024" };
+            for (int t = 0; t < 2; t++) {
+                WeatherState state;
+                WeatherSystem::init(state);
+                WeatherSystem::setWeather(state, types[t]);
+                measure("WeatherSystem::getWindSway", typeNames[t], N, UNLIMITED, [&] {
+                    float acc = 0.0f;
+                    for (int i = 0; i < N; i++) acc += WeatherSystem::getWindSway(state, float(i) * 0.1f);
+                    sink = acc;
+                });
+            }
+
+            // Particle loop at the pool size the scene uses, rain and snow paths
+            const WeatherType falling[2] = { WeatherType::RAIN, WeatherType::SNOW };
+            const char* fallingNames[2] = { "rain", "snow" };
+            for (int t = 0; t < 2; t++) {
+                WeatherState state;
+                WeatherSystem::init(state);
+                WeatherSystem::setWeather(state, falling[t]);
+                state.holdType = true;
+                char size[32];
+                snprintf(size, sizeof(size), "%d %s", int(state.particles.size()), fallingNames[t]);
+                measure("WeatherSystem::update", size, double(state.particles.size()), UNLIMITED, [&] {
+                    WeatherSystem::update(state, 0.5f, 800, 600);
+                });
+            }
+        }
+
+        void benchParticles() {
+            // Pool is filled with dust (long lived) once; 200 updates keep it full
+            const int pools[3] = { 500, 5000, 50000 };
+            ParticleState pool;
+            for (int n : pools) {
+                if (filter && !strstr("ParticleSystem::update", filter)) return;
+                Utils::seedRandom(1);
+                ParticleSystem::init(pool, n);
+                ParticleSystem::spawnDust(pool, n, 800, 600);
+                char size[32];
+                snprintf(size, sizeof(size), "%d pool", n);
+                measure("ParticleSystem::update", size, n, 200, [&] {
+                    ParticleSystem::update(pool, 0.01f, Utils::Season::SUMMER, 1.0f, 800, 600);
+                });
+            }
+        }
+
+        void benchVillagers() {
+            // One op = every villager takes a step (the proximity scan is the n^2 part)
+            const int crowds[3] = { 10, 100, 1000 };
+            for (int n : crowds) {
+                if (filter && !strstr("CharacterSystem::update", filter)) return;
+                Utils::seedRandom(1);
+                CharacterList villagers;
+                for (int i = 0; i < n; i++) villagers.push_back(CharacterSystem::create(Utils::random(-20.0f, 60.0f)));
+                char size[32];
+                snprintf(size, sizeof(size), "%d villagers", n);
+                float time = 8.0f;
+                measure("CharacterSystem::update", size, n, UNLIMITED, [&] {
+                    for (int i = 0; i < n; i++) CharacterSystem::update(villagers[i], time, villagers, i, 1.0f);
+                    time += 0.01f;
+                });
+            }
+        }
+    }
+
+    int run(int argc, char** argv) {
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+            else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) minSeconds = atof(argv[++i]);
+        }
+
+        GLStats::setNullSink(true);
+        Utils::seedRandom(1);
+
+        benchUtils();
+        benchStyle();
+        benchWeather();
+        benchParticles();
+        benchVillagers();
+        return 0;
+    }
+}
@@ -0,0 +1,12 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+// Kernel microbenchmarks (village.exe --microbench [--filter name] [--min-time sec]).
+// Times the small functions the frame calls thousands of times in isolation and
+// prints ns/op and items/sec. Draw kernels run against the GLStats null sink,
+// so no window or GL context is needed.
+namespace Microbench {
+    int run(int argc, char** argv);
+}
+
+#endif // MICROBENCH_H
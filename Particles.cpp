@@ -1,24 +1,29 @@
 #include "Particles.h"
+#include "Memory.h"
 #include <GL/glut.h>
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
 
 #include <vector>
 
 namespace ParticleSystem {
     
-    std::vector<Particle> particles; // Use the header definition
-    int maxP = 0;
+    void init(ParticleState& state, int maxParticles) {
+        state.pool.resize(maxParticles);
+        for(auto& p : state.pool) p.active = false;
+        state.liveCount = 0;
+    }
 
-    void init(int maxParticles) {
-        maxP = maxParticles;
-        particles.resize(maxP);
-        for(auto& p : particles) p.active = false;
+    void restorePool(ParticleState& state, const Particle* data, int count) {
+        state.pool.assign(data, data + count);
+        state.liveCount = 0;
+        for(const auto& p : state.pool) if (p.active) state.liveCount++;
     }
 
-    void spawnPollen(int count, int width, int height) {
+    void spawnPollen(ParticleState& state, int count, int width, int height) {
         for(int i=0; i<count; i++) {
-            for(auto& p : particles) {
+            for(auto& p : state.pool) {
                 if(!p.active) {
                     p.active = true;
                     p.type = ParticleType::POLLEN;
@@ -36,9 +41,9 @@ namespace ParticleSystem {
         }
     }
 
-    void spawnLeaves(int count, int width, int height, float wind) {
+    void spawnLeaves(ParticleState& state, int count, int width, int height, float wind) {
         for(int i=0; i<count; i++) {
-             for(auto& p : particles) {
+             for(auto& p : state.pool) {
                 if(!p.active) {
                     p.active = true;
                     p.type = ParticleType::LEAF;
@@ -59,10 +64,10 @@ namespace ParticleSystem {
         }
     }
     
-    void spawnSnowMicro(int count, int width, int height) {
+    void spawnSnowMicro(ParticleState& state, int count, int width, int height) {
         // Large flakes closer to camera
          for(int i=0; i<count; i++) {
-             for(auto& p : particles) {
+             for(auto& p : state.pool) {
                 if(!p.active) {
                     p.active = true;
                     p.type = ParticleType::SNOW_MICRO;
@@ -79,9 +84,9 @@ namespace ParticleSystem {
          }
     }
     
-    void spawnDust(int count, int width, int height) {
+    void spawnDust(ParticleState& state, int count, int width, int height) {
         for(int i=0; i<count; i++) {
-             for(auto& p : particles) {
+             for(auto& p : state.pool) {
                 if(!p.active) {
                     p.active = true;
                     p.type = ParticleType::DUST;
@@ -98,8 +103,10 @@ namespace ParticleSystem {
         }
     }
 
-    void spawnSmoke(float x, float y) {
-        for(auto& p : particles) {
+    void spawnSmoke(ParticleState& state, float x, float y) {
+        // Saturated pool: skip the scan (thousands of chimneys hit this every tick)
+        if (state.liveCount >= int(state.pool.size())) return;
+        for(auto& p : state.pool) {
             if(!p.active) {
                 p.active = true;
                 p.type = ParticleType::CHIMNEY_SMOKE;
@@ -111,25 +118,35 @@ namespace ParticleSystem {
                 p.color = Utils::Color(0.8f, 0.8f, 0.8f, 0.4f);
                 p.life = Utils::random(50.0f, 100.0f);
                 p.maxLife = p.life;
+                state.liveCount++;
                 break;
             }
         }
     }
 
-    void update(float timeSpeed, Utils::Season season, float windStrength, int width, int height) {
+    void updateEmitters(ParticleState& state, const EmitterList& emitters) {
+        for(const auto& e : emitters) {
+            float n = e.rate;
+            for(; n >= 1.0f; n -= 1.0f) spawnSmoke(state, e.x, e.y);
+            if (n > 0.0f && Utils::random(0.0f, 1.0f) < n) spawnSmoke(state, e.x, e.y);
+        }
+    }
+
+    void update(ParticleState& state, float timeSpeed, Utils::Season season, float windStrength, int width, int height) {
         
         // Seasonal Spawning Logic (Simple chance based)
         if (season == Utils::Season::SPRING) {
-            if (rand() % 100 < 5) spawnPollen(1, width, height); // Consistent flow
+            if (Utils::randomInt(100) < 5) spawnPollen(state, 1, width, height); // Consistent flow
         } else if (season == Utils::Season::AUTUMN) {
-            if (rand() % 100 < 3) spawnLeaves(1, width, height, windStrength);
+            if (Utils::randomInt(100) < 3) spawnLeaves(state, 1, width, height, windStrength);
         } else if (season == Utils::Season::WINTER) {
-             if (rand() % 100 < 5) spawnSnowMicro(1, width, height);
+             if (Utils::randomInt(100) < 5) spawnSnowMicro(state, 1, width, height);
         } else { // Summer
-             if (rand() % 100 < 2) spawnDust(1, width, height);
+             if (Utils::randomInt(100) < 2) spawnDust(state, 1, width, height);
         }
         
-        for(auto& p : particles) {
+        state.liveCount = 0;
+        for(auto& p : state.pool) {
             if (!p.active) continue;
             
             p.x += p.speedX;
@@ -156,15 +173,108 @@ namespace ParticleSystem {
 
             if (p.life <= 0 || p.y < -10 || p.y > height + 50 || p.x < -50 || p.x > width + 50) {
                 p.active = false;
+            } else {
+                state.liveCount++;
+            }
+        }
+    }
+
+    namespace {
+        Particle* firstFree(ParticleState& state) {
+            for(auto& p : state.pool) if (!p.active) return &p;
+            return nullptr;
+        }
+        
+        // update() ticks times over on one particle, drifting in a straight
+        // line (no flutter or waves). False once it is gone
+        bool age(Particle& p, long long ticks, float windStrength, int width, int height) {
+            float n = float(ticks);
+            p.life -= 0.5f * n;
+            if (p.life <= 0) {
+                p.active = false;
+                return false;
+            }
+            
+            float pushX = 0.0f;
+            if (p.type == ParticleType::LEAF) {
+                pushX = windStrength * 0.05f;
+                p.speedY = -0.5f; // Flutter averages out
+                p.rotation += p.rotSpeed * n;
+            } else if (p.type == ParticleType::POLLEN || p.type == ParticleType::SNOW_MICRO) {
+                pushX = windStrength * ((p.type == ParticleType::POLLEN) ? 0.02f : 0.05f);
+            } else if (p.type == ParticleType::CHIMNEY_SMOKE) {
+                pushX = windStrength * 0.1f;
+                p.size += 0.01f * n;
+                p.color.a = 0.4f * p.life / p.maxLife;
             }
+            p.x += (p.speedX + pushX) * n;
+            p.y += p.speedY * n;
+            
+            if (p.y < -10 || p.y > height + 50 || p.x < -50 || p.x > width + 50) {
+                p.active = false;
+                return false;
+            }
+            return true;
+        }
+        
+        // Draws for a steady flow of rate a tick over window ticks
+        int flowCount(float rate, long long window) {
+            float expected = rate * float(window);
+            int count = int(expected);
+            if (Utils::random(0.0f, 1.0f) < expected - float(count)) count++;
+            return count;
+        }
+    }
+    
+    void skip(ParticleState& state, long long ticks, Utils::Season season, float windStrength, int width, int height) {
+        if (ticks <= 0) return;
+        
+        // 1. The pool ages in one go
+        for(auto& p : state.pool) {
+            if (p.active) age(p, ticks, windStrength, width, height);
+        }
+        
+        // 2. The season's trickle as it stands after that long: spawned over
+        //    the last lifetime, each as old as it would be by now
+        float chance = 0.02f; // Summer dust
+        long long lifetime = 400;
+        if (season == Utils::Season::SPRING) { chance = 0.05f; lifetime = 200; }
+        else if (season == Utils::Season::AUTUMN) { chance = 0.03f; lifetime = 200; }
+        else if (season == Utils::Season::WINTER) { chance = 0.05f; lifetime = 200; }
+        long long window = std::min(ticks, lifetime);
+        int count = flowCount(chance, window);
+        for(int i = 0; i < count; i++) {
+            Particle* p = firstFree(state);
+            if (!p) break;
+            if (season == Utils::Season::SPRING) spawnPollen(state, 1, width, height);
+            else if (season == Utils::Season::AUTUMN) spawnLeaves(state, 1, width, height, windStrength);
+            else if (season == Utils::Season::WINTER) spawnSnowMicro(state, 1, width, height);
+            else spawnDust(state, 1, width, height);
+            age(*p, Utils::randomInt(int(window)), windStrength, width, height);
+        }
+        
+        state.liveCount = 0;
+        for(const auto& p : state.pool) if (p.active) state.liveCount++;
+    }
+    
+    void skipSmoke(ParticleState& state, float x, float y, float rate, long long ticks, float windStrength, int width, int height) {
+        // Smoke lasts 200 ticks at most (life 100)
+        long long window = std::min(ticks, 200LL);
+        if (window <= 0) return;
+        int count = flowCount(rate, window);
+        for(int i = 0; i < count; i++) {
+            Particle* p = firstFree(state);
+            if (!p) return;
+            spawnSmoke(state, x, y);
+            if (!age(*p, Utils::randomInt(int(window)), windStrength, width, height)) state.liveCount--;
         }
     }
 
-    void draw(float timeOfDay) {
+    void draw(const ParticleState& state, float timeOfDay) {
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         
-        for(const auto& p : particles) {
+        for(const auto& p : state.pool) {
             if (!p.active) continue;
             
             p.color.apply();
@@ -2,6 +2,7 @@
 #define PARTICLES_H
 
 #include "Utils.h"
+#include "Memory.h"
 #include <vector>
 
 enum class ParticleType {
@@ -25,17 +26,46 @@ struct Particle {
     bool active;
 };
 
+typedef MemoryTracker::Vector<Particle, MemoryTracker::PARTICLES> ParticleList;
+
+// Stationary smoke source (bonfires, stress testing)
+struct ParticleEmitter {
+    float x, y;
+    float rate; // Particles per tick (the fraction is a spawn chance)
+};
+
+typedef MemoryTracker::Vector<ParticleEmitter, MemoryTracker::PARTICLES> EmitterList;
+
+// Particle pool of one world (part of Scene::State, so forked worlds each have their own)
+struct ParticleState {
+    ParticleList pool;
+    int liveCount; // Active particles as of the last update (plus smoke spawned since)
+    
+    ParticleState() : liveCount(0) {}
+};
+
 namespace ParticleSystem {
-    void init(int maxParticles = 500);
-    void update(float timeSpeed, Utils::Season season, float windStrength, int width, int height);
-    void draw(float timeOfDay);
+    void init(ParticleState& state, int maxParticles = 500);
+    void updateEmitters(ParticleState& state, const EmitterList& emitters);
+    void update(ParticleState& state, float timeSpeed, Utils::Season season, float windStrength, int width, int height);
+    void draw(const ParticleState& state, float timeOfDay);
+    
+    // ticks of update() at once: particles age and drift in a straight line,
+    // and the season's own are topped up to a steady flow
+    void skip(ParticleState& state, long long ticks, Utils::Season season, float windStrength, int width, int height);
+    // The smoke a source spawning rate particles a tick leaves after ticks of it
+    // (call skip() first)
+    void skipSmoke(ParticleState& state, float x, float y, float rate, long long ticks, float windStrength, int width, int height);
+    
+    // Replace the whole pool (snapshots)
+    void restorePool(ParticleState& state, const Particle* data, int count);
     
     // Spawners
-    void spawnPollen(int count, int width, int height);
-    void spawnDust(int count, int width, int height);
-    void spawnLeaves(int count, int width, int height, float wind);
-    void spawnSnowMicro(int count, int width, int height);
-    void spawnSmoke(float x, float y);
+    void spawnPollen(ParticleState& state, int count, int width, int height);
+    void spawnDust(ParticleState& state, int count, int width, int height);
+    void spawnLeaves(ParticleState& state, int count, int width, int height, float wind);
+    void spawnSnowMicro(ParticleState& state, int count, int width, int height);
+    void spawnSmoke(ParticleState& state, float x, float y);
 }
 
 #endif // PARTICLES_H
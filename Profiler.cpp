@@ -0,0 +1,212 @@
+#include "Profiler.h"
+#include "Trace.h"
+#include "GLStats.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <algorithm>
+
+namespace Profiler {
+
+    namespace {
+        const int RING_SIZE = 4096; // Power of two
+        const int MAX_DEPTH = 32;
+
+        struct Sample {
+            const char* name;
+            unsigned pathId;
+            unsigned parentId;
+            int depth;
+            long long startNs;
+            long long endNs;
+        };
+
+        // Single producer (owning thread) / single consumer (endFrame)
+        struct ThreadRing {
+            Sample samples[RING_SIZE];
+            std::atomic<unsigned> head;
+            std::atomic<unsigned> tail;
+            unsigned dropped;
+            int threadId; // Registration order, used as the trace tid
+
+            ThreadRing() : head(0), tail(0), dropped(0), threadId(0) {}
+        };
+
+        struct Stage {
+            const char* name;
+            unsigned pathId;
+            unsigned parentId;
+            int depth;
+            float frameMs; // Accumulated during the current frame
+            double totalMs; // Since the last resetTotals()
+            float history[HISTORY_FRAMES];
+        };
+
+        std::atomic<bool> enabled(true);
+
+        std::mutex ringsMutex; // Guards registration and draining only
+        std::vector<ThreadRing*> rings;
+
+        std::vector<Stage> stages; // Main thread only
+        std::vector<Trace::Event> traceBatch;
+        int frameIndex = 0;
+        int framesRecorded = 0;
+
+        // Per-thread scope stack: path ids of the open scopes
+        thread_local ThreadRing* localRing = nullptr;
+        thread_local unsigned pathStack[MAX_DEPTH];
+        thread_local int depth = 0;
+
+        ThreadRing* getLocalRing() {
+            if (!localRing) {
+                // Rings are never freed so a finished thread's last samples stay readable
+                localRing = new ThreadRing();
+                std::lock_guard<std::mutex> lock(ringsMutex);
+                localRing->threadId = int(rings.size());
+                rings.push_back(localRing);
+            }
+            return localRing;
+        }
+
+        unsigned hashPath(unsigned parent, const char* name) {
+            // FNV-1a over the scope name chained onto the parent's path
+            unsigned h = parent ^ 2166136261u;
+            for (const char* c = name; *c != '\0'; c++) {
+                h ^= (unsigned char)*c;
+                h *= 16777619u;
+            }
+            return h ? h : 1;
+        }
+
+        Stage& findStage(const Sample& s) {
+            for (auto& st : stages) {
+                if (st.pathId == s.pathId) return st;
+            }
+            Stage st;
+            st.name = s.name;
+            st.pathId = s.pathId;
+            st.parentId = s.parentId;
+            st.depth = s.depth;
+            st.frameMs = 0.0f;
+            st.totalMs = 0.0;
+            std::fill(st.history, st.history + HISTORY_FRAMES, 0.0f);
+            stages.push_back(st);
+            return stages.back();
+        }
+
+        void appendChildren(unsigned parentId, std::vector<StageStats>& out) {
+            int count = std::min(framesRecorded, HISTORY_FRAMES);
+            for (const auto& st : stages) {
+                if (st.parentId != parentId) continue;
+
+                StageStats s;
+                s.name = st.name;
+                s.depth = st.depth;
+                s.lastMs = st.history[(frameIndex + HISTORY_FRAMES - 1) % HISTORY_FRAMES];
+                s.minMs = 1e9f; s.maxMs = 0.0f; s.avgMs = 0.0f;
+                for (int i = 0; i < count; i++) {
+                    float v = st.history[(frameIndex + HISTORY_FRAMES - 1 - i) % HISTORY_FRAMES];
+                    s.minMs = std::min(s.minMs, v);
+                    s.maxMs = std::max(s.maxMs, v);
+                    s.avgMs += v;
+                }
+                if (count > 0) s.avgMs /= count;
+                else s.minMs = 0.0f;
+                s.totalMs = st.totalMs;
+                out.push_back(s);
+
+                appendChildren(st.pathId, out);
+            }
+        }
+    }
+
+    long long nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    Scope::Scope(const char* n) : name(n), glSection(nullptr), pathId(0), parentId(0), startNs(0) {
+        glSection = GLStats::enterSection(name);
+        if (!enabled.load(std::memory_order_relaxed) || depth >= MAX_DEPTH) return;
+        parentId = (depth > 0) ? pathStack[depth - 1] : 0;
+        pathId = hashPath(parentId, name);
+        pathStack[depth++] = pathId;
+        startNs = nowNs();
+    }
+
+    Scope::~Scope() {
+        GLStats::leaveSection(glSection);
+        if (pathId == 0) return;
+        long long endNs = nowNs();
+        depth--;
+
+        ThreadRing* ring = getLocalRing();
+        unsigned head = ring->head.load(std::memory_order_relaxed);
+        unsigned tail = ring->tail.load(std::memory_order_acquire);
+        if (head - tail >= unsigned(RING_SIZE)) {
+            ring->dropped++; // Consumer fell behind, drop rather than block
+            return;
+        }
+
+        Sample& s = ring->samples[head & (RING_SIZE - 1)];
+        s.name = name;
+        s.pathId = pathId;
+        s.parentId = parentId;
+        s.depth = depth;
+        s.startNs = startNs;
+        s.endNs = endNs;
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    void setEnabled(bool e) {
+        enabled.store(e);
+    }
+
+    bool isEnabled() {
+        return enabled.load();
+    }
+
+    void endFrame() {
+        // 1. Drain all rings (and forward the raw samples when a trace is being captured)
+        bool tracing = Trace::isActive();
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            for (ThreadRing* ring : rings) {
+                unsigned tail = ring->tail.load(std::memory_order_relaxed);
+                unsigned head = ring->head.load(std::memory_order_acquire);
+                for (; tail != head; ++tail) {
+                    const Sample& s = ring->samples[tail & (RING_SIZE - 1)];
+                    findStage(s).frameMs += float(s.endNs - s.startNs) * 1e-6f;
+                    if (tracing) {
+                        Trace::Event e = { s.name, 'X', ring->threadId, s.startNs, s.endNs - s.startNs, 0 };
+                        traceBatch.push_back(e);
+                    }
+                }
+                ring->tail.store(tail, std::memory_order_release);
+            }
+        }
+
+        if (tracing) {
+            Trace::submit(traceBatch.data(), traceBatch.size());
+            traceBatch.clear();
+        }
+
+        // 2. Roll the frame into history
+        for (auto& st : stages) {
+            st.history[frameIndex] = st.frameMs;
+            st.totalMs += st.frameMs;
+            st.frameMs = 0.0f;
+        }
+        frameIndex = (frameIndex + 1) % HISTORY_FRAMES;
+        framesRecorded++;
+    }
+
+    void resetTotals() {
+        for (auto& st : stages) st.totalMs = 0.0;
+    }
+
+    void getStats(std::vector<StageStats>& out) {
+        out.clear();
+        appendChildren(0, out);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <vector>
+
+// Hierarchical frame profiler.
+// Scopes record begin/end timestamps into a per-thread ring buffer (no locks on
+// the recording path). Once per frame the main thread drains all rings and
+// folds the samples into per-stage history for the HUD.
+namespace Profiler {
+    const int HISTORY_FRAMES = 120;
+
+    struct Scope {
+        explicit Scope(const char* name);
+        ~Scope();
+
+        const char* name;
+        const char* glSection; // Previous GLStats section, restored on exit
+        unsigned pathId;
+        unsigned parentId;
+        long long startNs;
+    };
+
+    // Per-stage timings over the last HISTORY_FRAMES frames (milliseconds)
+    struct StageStats {
+        const char* name;
+        int depth;
+        float lastMs;
+        float minMs;
+        float avgMs;
+        float maxMs;
+        double totalMs; // Accumulated since resetTotals()
+    };
+
+    long long nowNs();
+    void setEnabled(bool enabled);
+    bool isEnabled();
+
+    // Drain every thread's ring and close the frame (call once per displayed frame)
+    void endFrame();
+
+    // Zero the accumulated totals (benchmarks call this before the timed ticks)
+    void resetTotals();
+
+    // Stages in tree order (parents before children)
+    void getStats(std::vector<StageStats>& out);
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+#endif // PROFILER_H
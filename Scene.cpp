@@ -3,6 +3,14 @@
 #include "Building.h"
 #include "Character.h"
 #include "Style.h"
+#include "Text.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "Trajectory.h"
+#include "Snapshot.h"
+#include "Journal.h"
+#include "Stream.h"
+#include "FastForward.h"
 #include <GL/glut.h>
 #include <iostream>
 
@@ -11,48 +19,171 @@ namespace Scene {
 
     State& getState() { return state; }
 
-    void init() {
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glEnable(GL_BLEND);
+    void dumpMetricsOnExit() {
+        Analytics::dumpHistograms(state.metrics, stdout);
+    }
+
+    namespace {
+        const SceneFile::Layout* worldLayout = nullptr; // Of the main world, for the spawner
+        
+        // Placement for the i-th entity: the layout's spots first, extras scattered
+        void addHouse(State& state, const SceneFile::Layout& layout, int i) {
+            if (i < int(layout.houses.size())) state.houses.push_back(Building::create(layout.houses[i].x, layout.houses[i].y));
+            else state.houses.push_back(Building::create(Utils::random(-30.0f, 95.0f), Utils::random(17.0f, 23.0f)));
+            Building::registerLights(state.houses.back(), state.lights);
+        }
+        
+        void addVillager(State& state, const SceneFile::Layout& layout, int i) {
+            if (i < int(layout.villagers.size())) {
+                const SceneFile::VillagerSpot& spot = layout.villagers[i];
+                Character c = CharacterSystem::create(spot.x);
+                c.homeMin = spot.homeMin;
+                c.homeMax = spot.homeMax;
+                state.villagers.push_back(c);
+                return;
+            }
+            state.villagers.push_back(CharacterSystem::create(Utils::random(-20.0f, 60.0f)));
+        }
+        
+        // Extras: every 5th animal is a bird
+        void addAnimal(State& state, const SceneFile::Layout& layout, int i) {
+            if (i < int(layout.animals.size())) {
+                const SceneFile::AnimalSpot& spot = layout.animals[i];
+                Animal a = AnimalSystem::create(spot.type, spot.x, spot.y);
+                a.homeMin = spot.homeMin;
+                a.homeMax = spot.homeMax;
+                state.animals.push_back(a);
+                return;
+            }
+            const AnimalType herdTypes[5] = { AnimalType::COW, AnimalType::COW, AnimalType::SHEEP, AnimalType::SHEEP, AnimalType::BIRD };
+            AnimalType type = herdTypes[i % 5];
+            if (type == AnimalType::BIRD) state.animals.push_back(AnimalSystem::create(type, Utils::random(-20.0f, 80.0f), Utils::random(45.0f, 55.0f)));
+            else state.animals.push_back(AnimalSystem::create(type, Utils::random(-20.0f, 80.0f), 20));
+        }
         
-        // Create diverse buildings
-        state.houses.push_back(Building::create(5, 20));
-        state.houses.push_back(Building::create(50, 22)); // Hill House
-        state.houses.push_back(Building::create(-15, 18));
+        void addEmitter(State& state, const SceneFile::Layout& layout, int i) {
+            if (i < int(layout.emitters.size())) {
+                state.emitters.push_back(layout.emitters[i]);
+                return;
+            }
+            ParticleEmitter e;
+            e.x = Utils::random(-20.0f, 80.0f);
+            e.y = Utils::random(15.0f, 25.0f);
+            e.rate = 0.5f;
+            state.emitters.push_back(e);
+        }
         
-        // Populate villagers
-        state.villagers.clear();
-        for(int i=0; i<5; i++) {
-             float x = float(i) * 15.0f - 10.0f;
-             state.villagers.push_back(CharacterSystem::create(x));
+        const SceneFile::Layout& spawnLayout() {
+            return worldLayout ? *worldLayout : SceneFile::builtin();
         }
         
-        // Animals
-        state.animals.push_back(AnimalSystem::create(AnimalType::COW, 5, 20));
-        state.animals.push_back(AnimalSystem::create(AnimalType::COW, 10, 20));
-        state.animals.push_back(AnimalSystem::create(AnimalType::SHEEP, 35, 20));
-        state.animals.push_back(AnimalSystem::create(AnimalType::SHEEP, 40, 20));
-        state.animals.push_back(AnimalSystem::create(AnimalType::BIRD, -10, 50));
+        // Index of the next spawned entity. A streamed world holds only part of the layout,
+        // so its spawns go past it (scattered extras) instead of taking spots a chunk builds later
+        int spawnIndex(size_t count, size_t laidOut) {
+            return int(WorldStream::isActive() ? std::max(count, laidOut) : count);
+        }
         
-        // Weather
-        WeatherSystem::init(state.weather);
-        state.currentWindSway = 0.0f;
+        // Streamed worlds start with the extras only, the layout comes in chunk by chunk
+        void build(State& state, const WorldConfig& config, bool streamed) {
+            state = State();
+            const SceneFile::Layout& layout = config.layout ? *config.layout : SceneFile::builtin();
+            
+            for(int i = streamed ? int(layout.houses.size()) : 0; i<config.houses; i++) addHouse(state, layout, i);
+            for(int i = streamed ? int(layout.villagers.size()) : 0; i<config.villagers; i++) addVillager(state, layout, i);
+            for(int i = streamed ? int(layout.animals.size()) : 0; i<config.animals; i++) addAnimal(state, layout, i);
+            for(int i = streamed ? int(layout.emitters.size()) : 0; i<config.emitters; i++) addEmitter(state, layout, i);
+            if (!streamed) state.decorations.assign(layout.decorations.begin(), layout.decorations.end());
+            
+            // Weather
+            WeatherSystem::init(state.weather);
+            state.currentWindSway = 0.0f;
+            
+            // Particles
+            ParticleSystem::init(state.particles, config.particlePool);
+            
+            // Camera
+            CameraSystem::init(state.camera);
+            
+            // Events & Analytics
+            EventSystem::init(state.events);
+            Analytics::init(state.metrics);
+            Analytics::initHeatmap(state.heatmap);
+        }
+    }
+
+    void buildWorld(const WorldConfig& config, bool streamed) {
+        worldLayout = config.layout;
+        WorldStream::stop();
+        streamed = streamed && config.layout && WorldStream::wanted(*config.layout);
+        build(state, config, streamed);
+        state.lod = streamed;
+        if (streamed) WorldStream::start(state, config);
+    }
+
+    void buildWorld(State& state, const WorldConfig& config) {
+        build(state, config, false);
+    }
+
+    void addChunk(State& state, const WorldConfig& config, const SceneFile::Chunk& chunk) {
+        const SceneFile::Layout& layout = *config.layout;
+        for(int i = chunk.houses.first; i < chunk.houses.first + chunk.houses.count && i < config.houses; i++) addHouse(state, layout, i);
+        for(int i = chunk.villagers.first; i < chunk.villagers.first + chunk.villagers.count && i < config.villagers; i++) addVillager(state, layout, i);
+        for(int i = chunk.animals.first; i < chunk.animals.first + chunk.animals.count && i < config.animals; i++) addAnimal(state, layout, i);
+        for(int i = chunk.emitters.first; i < chunk.emitters.first + chunk.emitters.count && i < config.emitters; i++) addEmitter(state, layout, i);
+        auto first = layout.decorations.begin() + chunk.decorations.first;
+        state.decorations.insert(state.decorations.end(), first, first + chunk.decorations.count);
+    }
+
+    void spawnVillagers(int count) {
+        Dormancy::settle(state);
+        for(int i=0; i<count; i++) addVillager(state, spawnLayout(), spawnIndex(state.villagers.size(), spawnLayout().villagers.size()));
+        for(int i=0; i<-count && !state.villagers.empty(); i++) state.villagers.pop_back();
+    }
+    
+    void spawnAnimals(int count) {
+        Dormancy::settle(state);
+        for(int i=0; i<count; i++) addAnimal(state, spawnLayout(), spawnIndex(state.animals.size(), spawnLayout().animals.size()));
+        for(int i=0; i<-count && !state.animals.empty(); i++) state.animals.pop_back();
+    }
+    
+    void spawnHouses(int count) {
+        for(int i=0; i<count; i++) addHouse(state, spawnLayout(), spawnIndex(state.houses.size(), spawnLayout().houses.size()));
+        for(int i=0; i<-count && !state.houses.empty(); i++) {
+            Building::unregisterLights(state.houses.back(), state.lights);
+            state.houses.pop_back();
+        }
+    }
+    
+    void spawnEmitters(int count) {
+        for(int i=0; i<count; i++) addEmitter(state, spawnLayout(), spawnIndex(state.emitters.size(), spawnLayout().emitters.size()));
+        for(int i=0; i<-count && !state.emitters.empty(); i++) state.emitters.pop_back();
+    }
+
+    void init(const WorldConfig& config) {
+        GLStats::bindThread();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glEnable(GL_BLEND);
         
-        // Particles
-        ParticleSystem::init(500);
+        buildWorld(config, true);
         
-        // Camera
-        CameraSystem::init(state.camera);
+        // HUD font (the atlas is baked on the first frame)
+        TextRenderer::init();
         
-        // Events & Analytics
-        EventSystem::init(state.events);
-        Analytics::init(state.metrics);
         state.metrics.active = true; // Enable by default for demo
+        atexit(dumpMetricsOnExit); // Frame/tick percentiles on ESC or window close
     }
 
-    void reshape(int w, int h) {
+    void resize(int w, int h) {
         state.width = w;
         state.height = h;
+    }
+
+    void reshape(int w, int h) {
+        // The simulation uses the window size (particle bounds); during a replay the journal drives it
+        if (!Journal::isReplaying()) {
+            Journal::recordResize(state.tick, w, h);
+            resize(w, h);
+        }
         glViewport(0, 0, w, h);
         
         glMatrixMode(GL_PROJECTION);
@@ -61,7 +192,7 @@ namespace Scene {
         glMatrixMode(GL_MODELVIEW);
     }
 
-    void updateSkyColors() {
+    void updateSkyColors(State& state) {
         float t = state.timeOfDay;
         float weatherIntensity = (state.weather.currentType == WeatherType::CLEAR) ? 0.0f : state.weather.intensity;
         
@@ -98,13 +229,16 @@ namespace Scene {
         state.ambientLight = Style::applyAtmosphere(baseAmbient, t, weatherIntensity);
     }
 
-    void update(int value) {
+    void step(State& state) {
+        state.tick++;
         state.timeOfDay += state.timeSpeed;
         if (state.timeOfDay >= 24.0f) state.timeOfDay = 0.0f;
         
         // Weather Update
-        // Weather Update
-        WeatherSystem::update(state.weather, state.timeSpeed * 50.0f, state.width, state.height); // Scaling speed for weather
+        {
+            PROFILE_SCOPE("Weather");
+            WeatherSystem::update(state.weather, state.timeSpeed * 50.0f, state.width, state.height); // Scaling speed for weather
+        }
         
         // Season Cycle
         state.seasonTimer += state.timeSpeed;
@@ -115,31 +249,70 @@ namespace Scene {
             state.currentSeason = (Utils::Season)s;
         }
 
-        updateSkyColors();
+        updateSkyColors(state);
         
         // Calculate Wind Sway
         state.currentWindSway = WeatherSystem::getWindSway(state.weather, state.timeOfDay + state.waveOffset);
 
-        // Lighting Update
-        std::vector<float> houseX, houseY;
-        for(const auto& h : state.houses) {
-            houseX.push_back(h.x);
-            houseY.push_back(h.y);
+        // Lighting Update (only dusk/dawn transitions touch the registry)
+        {
+            PROFILE_SCOPE("Lighting");
+            LightingSystem::updateSchedule(state.lights, state.timeOfDay);
+        }
+
+        // Buildings, Villagers & Animals (off-screen ones at reduced detail when LOD is on,
+        // dormant ones skipped otherwise; sleeping animals either way)
+        bool isNight = (state.timeOfDay < 6.0f || state.timeOfDay > 19.0f);
+        Lod::Frame lod = Lod::frame(state.camera, state.tick);
+        {
+            PROFILE_SCOPE("Buildings");
+            for(size_t i = 0; i < state.houses.size(); ++i) {
+                Building::update(state.houses[i], state.particles, state.timeOfDay, isNight);
+            }
+        }
+        
+        {
+            PROFILE_SCOPE("Villagers");
+            float charSpeedMod = WeatherSystem::walkSpeedMod(state.weather);
+            CharacterSystem::updateAll(state.villagers, state.timeOfDay, charSpeedMod,
+                                       state.lod ? &lod : nullptr, state.lod ? nullptr : &state.dormant.villagers);
+        }
+        
+        {
+            PROFILE_SCOPE("Animals");
+            AnimalSystem::updateAll(state.animals, state.timeOfDay, isNight, state.currentWindSway,
+                                    state.lod ? &lod : nullptr, &state.dormant.animals);
         }
-        LightingSystem::collectLights(state.lights, state.timeOfDay, houseX, houseY);
 
         // Particle Update
-        ParticleSystem::update(state.timeSpeed, state.currentSeason, state.weather.windStrength, state.width, state.height);
+        {
+            PROFILE_SCOPE("Particles");
+            ParticleSystem::updateEmitters(state.particles, state.emitters);
+            ParticleSystem::update(state.particles, state.timeSpeed, state.currentSeason, state.weather.windStrength, state.width, state.height);
+        }
         
         // Camera Update
-        CameraSystem::updateCinematic(state.camera, state.timeOfDay);
-        CameraSystem::update(state.camera);
+        {
+            PROFILE_SCOPE("Camera");
+            CameraSystem::updateCinematic(state.camera, state.timeOfDay);
+            CameraSystem::update(state.camera);
+        }
         
         // Event Update
-        EventSystem::update(state.events, state.timeSpeed, state.timeOfDay);
+        {
+            PROFILE_SCOPE("Events");
+            EventSystem::update(state.events, state.timeSpeed, state.timeOfDay);
+        }
         
         // Analytics Update
-        Analytics::update(state.metrics, (int)state.villagers.size() + (int)state.animals.size(), 500); // 500 fixed particles
+        {
+            PROFILE_SCOPE("Analytics");
+            // Population heatmap accumulates every tick so history exists when toggled on
+            Analytics::followHeatmap(state.heatmap, CameraSystem::backdropOffset(state.camera));
+            Analytics::decayHeatmap(state.heatmap);
+            for(const auto& v : state.villagers) Analytics::addHeat(state.heatmap, v.x, v.y);
+            for(const auto& a : state.animals) Analytics::addHeat(state.heatmap, a.x, a.y);
+        }
 
         // Clouds (Multiple Layers + Weather Wind)
         for(int i = 0; i < 3; i++) {
@@ -152,74 +325,155 @@ namespace Scene {
         if (state.boatX > 100) state.boatX = -30;
         
         state.waveOffset += 0.1f;
+    }
+
+    void tick() {
+        PROFILE_SCOPE("Update");
+        long long tickStartNs = Profiler::nowNs();
+        
+        step(state);
+        
+        // Chunk streaming follows the camera (no-op unless the village is wider than the window)
+        if (WorldStream::isActive()) {
+            PROFILE_SCOPE("Streaming");
+            WorldStream::update(state);
+            WorldStream::Stats st = WorldStream::stats();
+            state.metrics.chunksLive = st.liveChunks;
+            state.metrics.chunksStored = st.storedChunks;
+            state.metrics.chunksUnvisited = st.freshChunks;
+        }
+        
+        // Frame metrics (wall clock), main world only
+        {
+            PROFILE_SCOPE("Analytics");
+            Analytics::Population pop;
+            pop.villagers = (int)state.villagers.size();
+            pop.animals = (int)state.animals.size();
+            pop.houses = (int)state.houses.size();
+            pop.emitters = (int)state.emitters.size();
+            Analytics::update(state.metrics, pop, state.particles.liveCount);
+        }
+        
+        // Trajectory log (no-op unless --trajectory was given)
+        if (TrajectoryLog::isRecording()) {
+            PROFILE_SCOPE("Trajectory");
+            TrajectoryLog::record(state.tick, state.villagers, state.animals);
+        }
+        
+        Analytics::recordTick(state.metrics, Profiler::nowNs() - tickStartNs);
+        MemoryTracker::endTick();
+        Journal::afterTick(state.tick);
+        
+        // Live telemetry for external dashboards (no-op unless --telemetry was given)
+        if (Telemetry::isOpen()) {
+            Telemetry::Record r;
+            r.tick = state.tick;
+            r.villagers = (int)state.villagers.size();
+            r.animals = (int)state.animals.size();
+            r.houses = (int)state.houses.size();
+            r.weather = (int)state.weather.currentType;
+            r.weatherIntensity = state.weather.intensity;
+            r.windStrength = state.weather.windStrength;
+            r.timeOfDay = state.timeOfDay;
+            r.season = (int)state.currentSeason;
+            r.event = (int)state.events.currentEvent;
+            r.eventActive = state.events.isActive ? 1 : 0;
+            Analytics::publishTelemetry(state.metrics, r);
+        }
+    }
+
+    void update(int value) {
+        Journal::applyDue(state.tick); // Replayed inputs land between the same ticks as when recorded
+        tick();
+        
+        // Trace counters (no-op unless a capture is running)
+        Trace::counter("Entities", (long long)(state.villagers.size() + state.animals.size()));
+        Trace::counter("Particles", state.metrics.particleCount);
         
         glutPostRedisplay();
         glutTimerFunc(16, update, 0); // ~60 FPS
     }
 
     void display() {
+        PROFILE_SCOPE("Display");
+        TextRenderer::bake(); // No-op after the first frame
         glClear(GL_COLOR_BUFFER_BIT);
         glLoadIdentity();
         
         // 0. Camera - Apply for World Objects
         glPushMatrix(); 
         CameraSystem::apply(state.camera);
+        
+        // Backdrop layers follow the camera once it pans away from the village
+        float backdropX = CameraSystem::backdropOffset(state.camera);
 
         // 1. Atmospheric Sky & Stars (Draw HUGE to cover camera pan)
-        glPushMatrix();
-        glScalef(2.0f, 1.2f, 1.0f); 
-        glTranslatef(-20, -10, 0); 
-        SceneElements::drawSky(state.skyTop, state.skyBottom, state.timeOfDay);
-        glPopMatrix();
-        SceneElements::drawStars(state.timeOfDay, (state.timeOfDay > 19 || state.timeOfDay < 6) ? 0.8f : 0.0f);
-        
-        // 2. Celestial Bodies
-        SceneElements::drawSunAndMoon(state.timeOfDay);
-        
-        // 3. Background Volumetric Clouds
-        if (state.showClouds) 
-            SceneElements::drawClouds(state.layers[1].x, state.layers[1].alpha, state.layers[1].scale, state.layers[1].y);
+        {
+            PROFILE_SCOPE("Backdrop");
+            glPushMatrix();
+            glTranslatef(backdropX, 0, 0);
+            glPushMatrix();
+            glScalef(2.0f, 1.2f, 1.0f); 
+            glTranslatef(-20, -10, 0); 
+            SceneElements::drawSky(state.skyTop, state.skyBottom, state.timeOfDay);
+            glPopMatrix();
+            SceneElements::drawStars(state.timeOfDay, (state.timeOfDay > 19 || state.timeOfDay < 6) ? 0.8f : 0.0f);
+        
+            // 2. Celestial Bodies
+            SceneElements::drawSunAndMoon(state.timeOfDay);
+        
+            // 3. Background Volumetric Clouds
+            if (state.showClouds) 
+                SceneElements::drawClouds(state.layers[1].x, state.layers[1].alpha, state.layers[1].scale, state.layers[1].y);
 
-        // 4. Mountains
-        SceneElements::drawMountains(0, state.ambientLight, state.currentSeason);
+            // 4. Mountains
+            SceneElements::drawMountains(0, state.ambientLight, state.currentSeason);
 
-        // 5. Ground (Scale up X to cover pan)
-        glPushMatrix();
-        glScalef(3.0f, 1.0f, 1.0f);
-        glTranslatef(-40, 0, 0);
-        SceneElements::drawGround(state.width, state.height, state.ambientLight, state.currentSeason);
-        glPopMatrix();
+            // 5. Ground (Scale up X to cover pan)
+            glPushMatrix();
+            glScalef(3.0f, 1.0f, 1.0f);
+            glTranslatef(-40, 0, 0);
+            SceneElements::drawGround(state.width, state.height, state.ambientLight, state.currentSeason);
+            glPopMatrix();
 
-        // 6. River
-        SceneElements::drawRiver(state.timeOfDay, state.skyBottom, state.ambientLight, state.currentSeason);
-        
-        // 7. House & Trees & Boat (Midground)
-        SceneElements::drawBoat(state.boatX, 6 + sin(state.waveOffset * 0.5f) * 0.5f, state.ambientLight);
-        
-        // Update & Draw Buildings
-        bool isNight = (state.timeOfDay < 6.0f || state.timeOfDay > 19.0f);
-        for(size_t i = 0; i < state.houses.size(); ++i) {
-            Building::update(state.houses[i], state.timeOfDay, isNight);
-            Building::draw(state.houses[i], state.timeOfDay, state.ambientLight, state.currentSeason);
+            // 6. River
+            SceneElements::drawRiver(state.timeOfDay, state.skyBottom, state.ambientLight, state.currentSeason);
+            SceneElements::drawBoat(state.boatX, 6 + sin(state.waveOffset * 0.5f) * 0.5f, state.ambientLight);
+            glPopMatrix();
         }
         
-        SceneElements::drawTree(-8, 20, state.ambientLight, state.currentWindSway, state.currentSeason);
-        SceneElements::drawTree(60, 20, state.ambientLight, state.currentWindSway, state.currentSeason);
-        
-        // Update & Draw Characters
-        float charSpeedMod = 1.0f;
-        if (state.weather.currentType == WeatherType::RAIN) charSpeedMod = 0.7f;
-        if (state.weather.currentType == WeatherType::STORM) charSpeedMod = 0.4f;
-        
-        for(size_t i = 0; i < state.villagers.size(); ++i) {
-            CharacterSystem::update(state.villagers[i], state.timeOfDay, state.villagers, int(i), charSpeedMod);
-            CharacterSystem::draw(state.villagers[i], state.ambientLight);
-        }
-        
-        // Update & Draw Animals
-        for(size_t i = 0; i < state.animals.size(); ++i) {
-            AnimalSystem::update(state.animals[i], state.timeOfDay, isNight, state.currentWindSway);
-            AnimalSystem::draw(state.animals[i], state.ambientLight);
+        // 7. House & Trees (Midground)
+        {
+            PROFILE_SCOPE("Entities");
+        
+            // Shadow Pass (one batched draw, under every entity)
+            {
+                PROFILE_SCOPE("Shadows");
+                for(const auto& h : state.houses) Building::queueShadow(h);
+                for(const auto& v : state.villagers) CharacterSystem::queueShadow(v);
+                for(const auto& a : state.animals) AnimalSystem::queueShadow(a);
+                Style::flushSoftShadows();
+            }
+        
+            // Draw Buildings
+            for(size_t i = 0; i < state.houses.size(); ++i) {
+                Building::draw(state.houses[i], state.timeOfDay, state.ambientLight, state.currentSeason);
+            }
+        
+            // Trees stand with the houses
+            for(const auto& d : state.decorations) {
+                if (d.type == DecorationType::TREE) SceneElements::drawDecoration(d, state.ambientLight, state.currentWindSway, state.currentSeason);
+            }
+        
+            // Draw Characters
+            for(size_t i = 0; i < state.villagers.size(); ++i) {
+                CharacterSystem::draw(Dormancy::villager(state, i), state.ambientLight);
+            }
+        
+            // Draw Animals
+            for(size_t i = 0; i < state.animals.size(); ++i) {
+                AnimalSystem::draw(state.animals[i], state.ambientLight);
+            }
         }
         
         // 8. Foreground Clouds
@@ -229,40 +483,49 @@ namespace Scene {
         }
            
         // 9. Details
-        SceneElements::drawFoliage(-12, 18, state.ambientLight, state.currentWindSway, state.currentSeason);
-        SceneElements::drawFoliage(2, 18, state.ambientLight, state.currentWindSway, state.currentSeason);
-        SceneElements::drawFlowers(10, 15, state.ambientLight, state.currentWindSway, state.currentSeason);
-        SceneElements::drawFlowers(12, 16, state.ambientLight, state.currentWindSway, state.currentSeason);
+        for(const auto& d : state.decorations) {
+            if (d.type != DecorationType::TREE) SceneElements::drawDecoration(d, state.ambientLight, state.currentWindSway, state.currentSeason);
+        }
         
         // 10. Birds (Particles/Elements)
         if (state.showBirds && (state.timeOfDay > 6 && state.timeOfDay < 19)) {
-             float bx = -20 + fmod(state.timeOfDay * 15, 120); 
+             float bx = -20 + fmod(state.timeOfDay * 15, 120) + backdropX; 
              float by = 45 + sin(bx * 0.1f) * 4.0f;
              SceneElements::drawBird(bx, by, sin(state.waveOffset), state.ambientLight);
         }
         
         // 11. Weather/Particles (World Space)
-        WeatherSystem::draw(state.weather, state.width, state.height);
-        ParticleSystem::draw(state.timeOfDay);
+        {
+            PROFILE_SCOPE("Weather");
+            glPushMatrix();
+            glTranslatef(backdropX, 0, 0);
+            WeatherSystem::draw(state.weather, state.width, state.height);
+            glPopMatrix();
+        }
+        {
+            PROFILE_SCOPE("Particles");
+            ParticleSystem::draw(state.particles, state.timeOfDay);
+        }
         EventSystem::drawWorld(state.events);
         
         // --- Population Heatmap (Visual Data Overlay) ---
         if (state.metrics.showHeatmap) {
-            std::vector<float> xs;
-            for(auto& v : state.villagers) xs.push_back(v.x);
-            for(auto& a : state.animals) xs.push_back(a.x);
-            Analytics::drawHeatmap(xs, std::vector<float>(xs.size(), 10.0f));
+            PROFILE_SCOPE("Heatmap");
+            Analytics::drawHeatmap(state.heatmap);
         }
 
         glPopMatrix(); // End World Space (Camera)
         
         // 12. Lighting Overlay & Effects
-        glPushMatrix();
-        CameraSystem::apply(state.camera);
-        LightingSystem::drawLightingOverlay(state.width, state.height, state.timeOfDay, state.ambientLight, state.lights);
-        LightingSystem::drawGodRays(state.width, state.height, state.timeOfDay);
-        LightingSystem::drawBloom(state.lights);
-        glPopMatrix();
+        {
+            PROFILE_SCOPE("Lighting");
+            glPushMatrix();
+            CameraSystem::apply(state.camera);
+            LightingSystem::drawLightmap(state.timeOfDay, state.lights, backdropX);
+            glTranslatef(backdropX, 0, 0);
+            LightingSystem::drawGodRays(state.width, state.height, state.timeOfDay);
+            glPopMatrix();
+        }
 
         // 13. Screen Space Overlays (Fireflies, Analytics)
         // Set Pixel-perfect 2D Projection for UI
@@ -274,8 +537,11 @@ namespace Scene {
         glPushMatrix();
         glLoadIdentity();
 
-        EventSystem::drawScreen(state.events, state.width, state.height);
-        Analytics::draw(state.metrics, state.width, state.height);
+        EventSystem::drawScreen(state.events, state.width, state.height, state.tick / 60.0f);
+        {
+            PROFILE_SCOPE("HUD");
+            Analytics::draw(state.metrics, state.width, state.height);
+        }
 
         glMatrixMode(GL_PROJECTION);
         glPopMatrix();
@@ -287,6 +553,14 @@ namespace Scene {
     }
 
     void handleKeyboard(unsigned char key, int x, int y) {
+        // Live input is ignored while a journal is replaying (except ESC)
+        if (Journal::isReplaying() && key != 27) return;
+        Journal::recordKey(state.tick, key);
+        applyKey(key);
+        glutPostRedisplay();
+    }
+
+    void applyKey(unsigned char key) {
         switch (key) {
         case 'n': case 'N':
             state.timeSpeed = 0.5f; // Fast forward
@@ -294,22 +568,64 @@ namespace Scene {
         case 'm': case 'M':
             state.timeSpeed = 0.01f; // Normal
             break;
+        // Skip ahead without stepping: to the next dawn, or a week
+        case 'd': case 'D':
+            FastForward::advance(state, FastForward::hoursToDawn(state));
+            break;
+        case 'w': case 'W':
+            FastForward::advance(state, 7 * 24.0);
+            break;
         case 'g': case 'G':
             state.metrics.active = !state.metrics.active;
             break;
         case 'h': case 'H':
             state.metrics.showHeatmap = !state.metrics.showHeatmap;
             break;
+        case 'p': case 'P':
+            state.metrics.showProfiler = !state.metrics.showProfiler;
+            break;
+        case 't': case 'T':
+            if (Trace::isActive()) Trace::stop();
+            else Trace::start("village_trace.json");
+            break;
         case 'c': case 'C':
             state.showClouds = !state.showClouds;
             break;
         case 'b': case 'B':
             state.showBirds = !state.showBirds;
             break;
+        // Stress spawner: lowercase adds a batch, uppercase removes one, [ ] scale the batch
+        case 'v': spawnVillagers(state.spawnBatch); break;
+        case 'V': spawnVillagers(-state.spawnBatch); break;
+        case 'a': spawnAnimals(state.spawnBatch); break;
+        case 'A': spawnAnimals(-state.spawnBatch); break;
+        case 'o': spawnHouses(state.spawnBatch); break;
+        case 'O': spawnHouses(-state.spawnBatch); break;
+        case 'e': spawnEmitters(state.spawnBatch); break;
+        case 'E': spawnEmitters(-state.spawnBatch); break;
+        case 'k': case 'K':
+            Snapshot::save(Snapshot::DEFAULT_PATH);
+            break;
+        case 'l': case 'L':
+            Snapshot::load(Snapshot::DEFAULT_PATH);
+            break;
+        case ']':
+            if (state.spawnBatch < 10000) state.spawnBatch *= 10;
+            break;
+        case '[':
+            if (state.spawnBatch > 1) state.spawnBatch /= 10;
+            break;
+        // Camera: , . pan, < > jump ten chunks, r resumes the cinematic tour
+        case ',': CameraSystem::panBy(state.camera, -40.0f); break;
+        case '.': CameraSystem::panBy(state.camera, 40.0f); break;
+        case '<': CameraSystem::panBy(state.camera, -10 * SceneFile::CHUNK_WIDTH); break;
+        case '>': CameraSystem::panBy(state.camera, 10 * SceneFile::CHUNK_WIDTH); break;
+        case 'r': case 'R':
+            state.camera.isCinematic = true;
+            break;
         case 27: // ESC
             exit(0);
             break;
         }
-        glutPostRedisplay();
     }
 }
@@ -13,6 +13,8 @@
 #include "Camera.h"
 #include "Events.h"
 #include "Analytics.h"
+#include "SceneFile.h"
+#include "Dormancy.h"
 
 namespace Scene {
     
@@ -31,6 +33,8 @@ namespace Scene {
         // Time/Cycle (0.00 to 24.00)
         float timeOfDay; // 0.0 -> 24.0
         float timeSpeed;
+        long long tick; // Simulation steps since buildWorld
+        bool lod; // Off-screen villagers and animals update less often (Lod.h)
         
         // Seasons
         Utils::Season currentSeason;
@@ -60,16 +64,21 @@ namespace Scene {
         int height;
         
         // Objects
-        std::vector<BuildingProps> houses;
-        std::vector<Character> villagers;
-        std::vector<Animal> animals;
+        BuildingList houses;
+        CharacterList villagers;
+        AnimalList animals;
+        Dormancy::Lists dormant; // Villagers and animals a tick can skip
+        EmitterList emitters;
+        DecorationList decorations;
+        ParticleState particles;
+        int spawnBatch; // Stress spawner step (keys [ and ])
         
         // Weather
         WeatherState weather;
         float currentWindSway;
         
-        // Lighting
-        std::vector<LightSource> lights;
+        // Lighting (persistent, updated on transitions only)
+        LightRegistry lights;
         
         // Camera
         CameraSystem::CameraState camera;
@@ -77,9 +86,10 @@ namespace Scene {
         // Advanced
         EventState events;
         Analytics::Metrics metrics;
+        Analytics::Heatmap heatmap;
         
         State() : 
-            timeOfDay(12.0f), timeSpeed(0.01f), // Start at Noon
+            timeOfDay(12.0f), timeSpeed(0.01f), tick(0), lod(false), // Start at Noon
             currentSeason(Utils::Season::SPRING), seasonTimer(0.0f),
             isDay(true), showClouds(true), showBirds(true), showStars(false),
             skyTop(0.0f, 0.4f, 0.8f), skyBottom(0.5f, 0.7f, 1.0f), ambientLight(1.0f, 1.0f, 1.0f),
@@ -90,18 +100,57 @@ namespace Scene {
                 CloudLayer(-10, 45, 0.07f, 2.5f, 0.9f)
             },
             width(800), height(600),
+            spawnBatch(10),
             currentWindSway(0.0f)
         {}
     };
 
-    void init();
+    // World size; the defaults are the hand-placed demo village. The first
+    // entities of each kind go where the layout puts them, extras are scattered
+    struct WorldConfig {
+        int houses;
+        int villagers;
+        int animals;
+        int particlePool;
+        int emitters;
+        const SceneFile::Layout* layout; // nullptr = SceneFile::builtin(); must outlive the world
+        
+        WorldConfig() : houses(3), villagers(5), animals(5), particlePool(500), emitters(0), layout(nullptr) {}
+        
+        // Exactly what the layout describes
+        explicit WorldConfig(const SceneFile::Layout& l) :
+            houses(int(l.houses.size())), villagers(int(l.villagers.size())), animals(int(l.animals.size())),
+            particlePool(l.particlePool), emitters(int(l.emitters.size())), layout(&l) {}
+    };
+
+    void init(const WorldConfig& config = WorldConfig());
+    
+    // Resets the main world, no GL needed. streamed: a layout wider than the
+    // streaming window is brought in around the camera by WorldStream instead
+    // of being built in full (interactive runs and their replays), with LOD on
+    void buildWorld(const WorldConfig& config, bool streamed = false);
+    void buildWorld(State& state, const WorldConfig& config); // Any world (batch runs build theirs on worker threads)
+    
+    // The layout's entities in one chunk (within the config's counts)
+    void addChunk(State& state, const WorldConfig& config, const SceneFile::Chunk& chunk);
+    
+    // Stress spawner: add count entities (negative removes the most recent ones)
+    void spawnVillagers(int count);
+    void spawnAnimals(int count);
+    void spawnHouses(int count);
+    void spawnEmitters(int count);
+    
+    void step(State& state); // One simulation step of any world (forks run this on worker threads)
+    void tick(); // step() on the main world plus its recorders, no GL needed (benchmarks drive this directly)
     void update(int value); // Timer callback
     void display();
     void reshape(int w, int h);
     void handleKeyboard(unsigned char key, int x, int y);
+    void applyKey(unsigned char key); // Simulation side of a key press (replays call this directly)
+    void resize(int w, int h); // Simulation side of reshape
     
     // Calculate sky colors based on time
-    void updateSkyColors();
+    void updateSkyColors(State& state);
     
     // Accessor for main
     State& getState(); 
@@ -380,4 +380,12 @@ namespace SceneElements {
         center.apply();
         Utils::drawCircle(0.3f, x + sway, y + 3, 10, true);
     }
+
+    void drawDecoration(const Decoration& d, const Utils::Color& tint, float sway, Utils::Season season) {
+        switch (d.type) {
+            case DecorationType::TREE: drawTree(d.x, d.y, tint, sway, season); break;
+            case DecorationType::FOLIAGE: drawFoliage(d.x, d.y, tint, sway, season); break;
+            case DecorationType::FLOWERS: drawFlowers(d.x, d.y, tint, sway, season); break;
+        }
+    }
 }
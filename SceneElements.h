@@ -2,6 +2,21 @@
 #define SCENE_ELEMENTS_H
 
 #include "Utils.h"
+#include "Memory.h"
+
+// Static scenery placed by the scene description
+enum class DecorationType {
+    TREE,
+    FOLIAGE,
+    FLOWERS
+};
+
+struct Decoration {
+    DecorationType type;
+    float x, y;
+};
+
+typedef MemoryTracker::Vector<Decoration, MemoryTracker::SCENERY> DecorationList;
 
 namespace SceneElements {
 
@@ -25,6 +40,7 @@ namespace SceneElements {
     // Details
     void drawFoliage(float x, float y, const Utils::Color& tint, float sway = 0.0f, Utils::Season season = Utils::Season::SPRING);
     void drawFlowers(float x, float y, const Utils::Color& tint, float sway = 0.0f, Utils::Season season = Utils::Season::SPRING);
+    void drawDecoration(const Decoration& d, const Utils::Color& tint, float sway, Utils::Season season);
     
     // Helper
     void setTint(const Utils::Color& tint);
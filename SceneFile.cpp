@@ -0,0 +1,354 @@
+#include "SceneFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <type_traits>
+
+namespace SceneFile {
+
+    namespace {
+        const uint32_t MAGIC = 0x4e435356; // "VSCN"
+        const uint32_t VERSION = 2;
+
+        enum SectionId {
+            HOUSES, VILLAGERS, ANIMALS, EMITTERS, DECORATIONS, CHUNKS,
+            SECTION_COUNT
+        };
+
+        // Sections follow the header back to back, in SectionId order
+        struct CacheHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t sourceSize;  // Of the text file the cache was built from
+            int64_t sourceMtime;
+            int32_t particlePool;
+            uint32_t elemSize[SECTION_COUNT];
+            uint32_t count[SECTION_COUNT];
+        };
+
+        static_assert(std::is_trivially_copyable<AnimalSpot>::value, "cache sections must be raw copies");
+        static_assert(std::is_trivially_copyable<ParticleEmitter>::value, "cache sections must be raw copies");
+        static_assert(std::is_trivially_copyable<Decoration>::value, "cache sections must be raw copies");
+        static_assert(std::is_trivially_copyable<Chunk>::value, "cache sections must be raw copies");
+
+        const float VILLAGER_HOME_MIN = -20.0f, VILLAGER_HOME_MAX = 60.0f; // As in CharacterSystem::create
+        const float ANIMAL_HOME_MIN = -20.0f, ANIMAL_HOME_MAX = 80.0f, BIRD_HOME_MAX = 100.0f; // As in AnimalSystem::create
+
+        bool sourceStamp(const char* path, uint64_t& size, int64_t& mtime) {
+            struct stat st;
+            if (stat(path, &st) != 0) return false;
+            size = uint64_t(st.st_size);
+            mtime = int64_t(st.st_mtime);
+            return true;
+        }
+
+        bool parse(const char* path, Layout& out) {
+            FILE* f = fopen(path, "r");
+            if (!f) {
+                fprintf(stderr, "Scene: cannot open %s\n", path);
+                return false;
+            }
+
+            out = Layout();
+            char line[256];
+            int lineNo = 0;
+            bool ok = true;
+            while (fgets(line, sizeof(line), f)) {
+                lineNo++;
+                char* comment = strchr(line, '#');
+                if (comment) *comment = '\0';
+
+                char word[32];
+                float a = 0, b = 0, c = 0, d = 0, e = 0;
+                int n = sscanf(line, "%31s %f %f %f %f %f", word, &a, &b, &c, &d, &e);
+                if (n <= 0) continue; // Blank line
+
+                if (strcmp(word, "house") == 0 && n >= 3) {
+                    Spot s = { a, b };
+                    out.houses.push_back(s);
+                } else if (strcmp(word, "villager") == 0 && (n == 2 || n == 4)) {
+                    VillagerSpot s = villagerAt(a);
+                    if (n == 4) { s.homeMin = b; s.homeMax = c; }
+                    out.villagers.push_back(s);
+                } else if ((strcmp(word, "cow") == 0 || strcmp(word, "sheep") == 0 || strcmp(word, "bird") == 0) && (n == 3 || n == 5)) {
+                    AnimalType type = (word[0] == 'c') ? AnimalType::COW : (word[0] == 's') ? AnimalType::SHEEP : AnimalType::BIRD;
+                    AnimalSpot s = animalAt(type, a, b);
+                    if (n == 5) { s.homeMin = c; s.homeMax = d; }
+                    out.animals.push_back(s);
+                } else if ((strcmp(word, "tree") == 0 || strcmp(word, "foliage") == 0 || strcmp(word, "flowers") == 0) && n >= 3) {
+                    DecorationType type = (word[0] == 't') ? DecorationType::TREE : (word[1] == 'o') ? DecorationType::FOLIAGE : DecorationType::FLOWERS;
+                    Decoration d = { type, a, b };
+                    out.decorations.push_back(d);
+                } else if (strcmp(word, "emitter") == 0 && n >= 4) {
+                    ParticleEmitter e = { a, b, c };
+                    out.emitters.push_back(e);
+                } else if (strcmp(word, "particles") == 0 && n >= 2) {
+                    out.particlePool = int(a);
+                } else {
+                    fprintf(stderr, "%s:%d: cannot read \"%s\"\n", path, lineNo, word);
+                    ok = false;
+                }
+            }
+            fclose(f);
+            if (ok) sortIntoChunks(out);
+            return ok;
+        }
+
+        template <typename T>
+        void putSection(FILE* f, CacheHeader& h, SectionId id, const std::vector<T>& list) {
+            h.elemSize[id] = uint32_t(sizeof(T));
+            h.count[id] = uint32_t(list.size());
+            if (!list.empty()) fwrite(list.data(), sizeof(T), list.size(), f);
+        }
+
+        void writeCache(const char* path, const Layout& layout, uint64_t size, int64_t mtime) {
+            // Write beside the target and rename, like snapshots
+            std::string target = cachePath(path);
+            std::string tmp = target + ".tmp";
+            FILE* f = fopen(tmp.c_str(), "wb");
+            if (!f) return; // Read-only location: keep working from the text file
+
+            CacheHeader h;
+            memset((void*)&h, 0, sizeof(h));
+            h.magic = MAGIC;
+            h.version = VERSION;
+            h.sourceSize = size;
+            h.sourceMtime = mtime;
+            h.particlePool = layout.particlePool;
+            fwrite(&h, sizeof(h), 1, f); // Placeholder until the counts are known
+            putSection(f, h, HOUSES, layout.houses);
+            putSection(f, h, VILLAGERS, layout.villagers);
+            putSection(f, h, ANIMALS, layout.animals);
+            putSection(f, h, EMITTERS, layout.emitters);
+            putSection(f, h, DECORATIONS, layout.decorations);
+            putSection(f, h, CHUNKS, layout.chunks);
+            fseek(f, 0, SEEK_SET);
+            bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+            ok = (fclose(f) == 0) && ok;
+
+            remove(target.c_str());
+            if (!ok || rename(tmp.c_str(), target.c_str()) != 0) {
+                fprintf(stderr, "Scene: failed writing %s\n", target.c_str());
+                remove(tmp.c_str());
+            }
+        }
+
+        template <typename T>
+        bool getSection(FILE* f, const CacheHeader& h, SectionId id, std::vector<T>& list) {
+            if (h.elemSize[id] != sizeof(T)) return false;
+            list.resize(h.count[id]);
+            return list.empty() || fread(list.data(), sizeof(T), list.size(), f) == list.size();
+        }
+
+        bool fits(const Range& r, size_t size) {
+            return r.first >= 0 && r.count >= 0 && size_t(r.first) + size_t(r.count) <= size;
+        }
+
+        // A cache that passes the size/mtime key can still be stale or truncated:
+        // Scene::addChunk indexes the arrays with these ranges unchecked
+        bool chunksFit(const Layout& l) {
+            for (const Chunk& c : l.chunks) {
+                if (!fits(c.houses, l.houses.size()) || !fits(c.villagers, l.villagers.size()) ||
+                    !fits(c.animals, l.animals.size()) || !fits(c.emitters, l.emitters.size()) ||
+                    !fits(c.decorations, l.decorations.size())) return false;
+            }
+            return true;
+        }
+
+        // False when the cache is missing, from another build or older than the text
+        bool readCache(const char* path, Layout& out, uint64_t size, int64_t mtime) {
+            FILE* f = fopen(cachePath(path).c_str(), "rb");
+            if (!f) return false;
+
+            CacheHeader h;
+            bool ok = fread(&h, sizeof(h), 1, f) == 1
+                && h.magic == MAGIC && h.version == VERSION
+                && h.sourceSize == size && h.sourceMtime == mtime;
+            if (ok) {
+                out.particlePool = h.particlePool;
+                ok = getSection(f, h, HOUSES, out.houses)
+                    && getSection(f, h, VILLAGERS, out.villagers)
+                    && getSection(f, h, ANIMALS, out.animals)
+                    && getSection(f, h, EMITTERS, out.emitters)
+                    && getSection(f, h, DECORATIONS, out.decorations)
+                    && getSection(f, h, CHUNKS, out.chunks)
+                    && chunksFit(out);
+            }
+            fclose(f);
+            return ok;
+        }
+
+        // The hand-placed demo village
+        Layout makeBuiltin() {
+            Layout layout;
+            const Spot houses[3] = { {5, 20}, {50, 22}, {-15, 18} }; // 50,22 = Hill House
+            const AnimalSpot herd[5] = {
+                animalAt(AnimalType::COW, 5, 20), animalAt(AnimalType::COW, 10, 20),
+                animalAt(AnimalType::SHEEP, 35, 20), animalAt(AnimalType::SHEEP, 40, 20),
+                animalAt(AnimalType::BIRD, -10, 50)
+            };
+            const Decoration scenery[6] = {
+                { DecorationType::TREE, -8, 20 }, { DecorationType::TREE, 60, 20 },
+                { DecorationType::FOLIAGE, -12, 18 }, { DecorationType::FOLIAGE, 2, 18 },
+                { DecorationType::FLOWERS, 10, 15 }, { DecorationType::FLOWERS, 12, 16 }
+            };
+            layout.houses.assign(houses, houses + 3);
+            for (int i = 0; i < 5; i++) layout.villagers.push_back(villagerAt(float(i) * 15.0f - 10.0f));
+            layout.animals.assign(herd, herd + 5);
+            layout.decorations.assign(scenery, scenery + 6);
+            sortIntoChunks(layout);
+            return layout;
+        }
+
+        // Walkers belong to the chunk their home range starts in, the rest to where they stand
+        float anchorX(const Spot& s) { return s.x; }
+        float anchorX(const VillagerSpot& s) { return s.homeMin; }
+        float anchorX(const AnimalSpot& s) { return s.homeMin; }
+        float anchorX(const ParticleEmitter& e) { return e.x; }
+        float anchorX(const Decoration& d) { return d.x; }
+
+        template <typename T>
+        void sortByChunk(std::vector<T>& list) {
+            std::stable_sort(list.begin(), list.end(), [](const T& a, const T& b) { return chunkOf(anchorX(a)) < chunkOf(anchorX(b)); });
+        }
+
+        template <typename T>
+        void addChunkIndices(const std::vector<T>& list, std::vector<int>& indices) {
+            for (const T& item : list) indices.push_back(chunkOf(anchorX(item)));
+        }
+
+        // Runs of one chunk in an already sorted list
+        template <typename T>
+        void fillRanges(const std::vector<T>& list, std::vector<Chunk>& chunks, Range Chunk::* range) {
+            size_t i = 0;
+            while (i < list.size()) {
+                int index = chunkOf(anchorX(list[i]));
+                size_t end = i;
+                while (end < list.size() && chunkOf(anchorX(list[end])) == index) end++;
+                Chunk& chunk = *std::lower_bound(chunks.begin(), chunks.end(), index,
+                                                 [](const Chunk& c, int v) { return c.index < v; });
+                chunk.*range = Range{ int(i), int(end - i) };
+                i = end;
+            }
+        }
+
+        const char* animalWord(AnimalType type) {
+            switch (type) {
+                case AnimalType::COW: return "cow";
+                case AnimalType::SHEEP: return "sheep";
+                default: return "bird";
+            }
+        }
+
+        const char* decorationWord(DecorationType type) {
+            switch (type) {
+                case DecorationType::TREE: return "tree";
+                case DecorationType::FOLIAGE: return "foliage";
+                default: return "flowers";
+            }
+        }
+    }
+
+    int chunkOf(float x) {
+        return int(std::floor((x - CHUNK_ORIGIN) / CHUNK_WIDTH));
+    }
+
+    float chunkStart(int index) {
+        return CHUNK_ORIGIN + float(index) * CHUNK_WIDTH;
+    }
+
+    VillagerSpot villagerAt(float x) {
+        VillagerSpot s = { x, VILLAGER_HOME_MIN, VILLAGER_HOME_MAX };
+        return s;
+    }
+
+    AnimalSpot animalAt(AnimalType type, float x, float y) {
+        AnimalSpot s = { type, x, y, ANIMAL_HOME_MIN, (type == AnimalType::BIRD) ? BIRD_HOME_MAX : ANIMAL_HOME_MAX };
+        return s;
+    }
+
+    void sortIntoChunks(Layout& layout) {
+        sortByChunk(layout.houses);
+        sortByChunk(layout.villagers);
+        sortByChunk(layout.animals);
+        sortByChunk(layout.emitters);
+        sortByChunk(layout.decorations);
+
+        std::vector<int> indices;
+        addChunkIndices(layout.houses, indices);
+        addChunkIndices(layout.villagers, indices);
+        addChunkIndices(layout.animals, indices);
+        addChunkIndices(layout.emitters, indices);
+        addChunkIndices(layout.decorations, indices);
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+        layout.chunks.clear();
+        for (int index : indices) {
+            Chunk c;
+            memset(&c, 0, sizeof(c));
+            c.index = index;
+            layout.chunks.push_back(c);
+        }
+        fillRanges(layout.houses, layout.chunks, &Chunk::houses);
+        fillRanges(layout.villagers, layout.chunks, &Chunk::villagers);
+        fillRanges(layout.animals, layout.chunks, &Chunk::animals);
+        fillRanges(layout.emitters, layout.chunks, &Chunk::emitters);
+        fillRanges(layout.decorations, layout.chunks, &Chunk::decorations);
+    }
+
+    const Layout& builtin() {
+        static const Layout layout = makeBuiltin(); // Thread-safe init, batch workers build worlds concurrently
+        return layout;
+    }
+
+    std::string cachePath(const char* path) {
+        return std::string(path) + ".cache";
+    }
+
+    bool load(const char* path, Layout& out, bool* fromCache) {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        if (!sourceStamp(path, size, mtime)) {
+            fprintf(stderr, "Scene: cannot open %s\n", path);
+            return false;
+        }
+
+        // 1. Up-to-date cache: no parsing at all
+        if (readCache(path, out, size, mtime)) {
+            if (fromCache) *fromCache = true;
+            return true;
+        }
+
+        // 2. Parse the text and refresh the cache for next time
+        if (fromCache) *fromCache = false;
+        if (!parse(path, out)) return false;
+        writeCache(path, out, size, mtime);
+        return true;
+    }
+
+    bool save(const char* path, const Layout& layout) {
+        FILE* f = fopen(path, "w");
+        if (!f) {
+            fprintf(stderr, "Scene: cannot write %s\n", path);
+            return false;
+        }
+
+        // %.9g round-trips floats exactly, so a saved layout loads back unchanged
+        fprintf(f, "# Village layout (%d chunks of %g units)\n\n", int(layout.chunks.size()), CHUNK_WIDTH);
+        fprintf(f, "particles %d\n\n", layout.particlePool);
+        for (const auto& h : layout.houses) fprintf(f, "house %.9g %.9g\n", h.x, h.y);
+        for (const auto& v : layout.villagers) fprintf(f, "villager %.9g %.9g %.9g\n", v.x, v.homeMin, v.homeMax);
+        for (const auto& a : layout.animals) fprintf(f, "%s %.9g %.9g %.9g %.9g\n", animalWord(a.type), a.x, a.y, a.homeMin, a.homeMax);
+        for (const auto& d : layout.decorations) fprintf(f, "%s %.9g %.9g\n", decorationWord(d.type), d.x, d.y);
+        for (const auto& e : layout.emitters) fprintf(f, "emitter %.9g %.9g %.9g\n", e.x, e.y, e.rate);
+
+        bool ok = !ferror(f);
+        ok = (fclose(f) == 0) && ok;
+        if (!ok) fprintf(stderr, "Scene: failed writing %s\n", path);
+        return ok;
+    }
+}
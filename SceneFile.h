@@ -0,0 +1,100 @@
+#ifndef SCENE_FILE_H
+#define SCENE_FILE_H
+
+#include <string>
+#include <vector>
+#include "Animal.h"
+#include "Particles.h"
+#include "SceneElements.h"
+
+// Data-driven village layout.
+// A scene description is a text file with one object per line:
+//
+//     # comment
+//     house    <x> <y>
+//     villager <x> [<home min> <home max>]
+//     cow|sheep|bird <x> <y> [<home min> <home max>]
+//     tree|foliage|flowers <x> <y>
+//     emitter  <x> <y> <rate>
+//     particles <pool size>
+//
+// The home range bounds where a villager walks or an animal roams (default:
+// the demo village's strip). Objects are grouped into CHUNK_WIDTH wide strips
+// along x after loading (villagers and animals by where their home range
+// starts), so big villages can be streamed and culled by chunk.
+//
+// Parsing it writes a binary cache next to the file (<file>.cache: the same
+// arrays as raw structs). Later loads use the cache while its recorded size and
+// modification time still match the text file, so large authored villages
+// start without any parsing.
+namespace SceneFile {
+    struct Spot {
+        float x, y;
+    };
+
+    // Villagers walk along the ground line, so only x is given
+    struct VillagerSpot {
+        float x;
+        float homeMin, homeMax;
+    };
+
+    struct AnimalSpot {
+        AnimalType type;
+        float x, y;
+        float homeMin, homeMax;
+    };
+
+    // Chunk c covers x in [CHUNK_ORIGIN + c * CHUNK_WIDTH, + CHUNK_WIDTH); the
+    // demo village fits in chunk 0
+    const float CHUNK_ORIGIN = -20.0f;
+    const float CHUNK_WIDTH = 160.0f;
+
+    // A slice [first, first + count) of one of the layout's arrays
+    struct Range {
+        int first, count;
+    };
+
+    // One occupied chunk and the objects standing in it
+    struct Chunk {
+        int index;
+        Range houses, villagers, animals, emitters, decorations;
+    };
+
+    struct Layout {
+        std::vector<Spot> houses;
+        std::vector<VillagerSpot> villagers;
+        std::vector<AnimalSpot> animals;
+        std::vector<ParticleEmitter> emitters;
+        std::vector<Decoration> decorations;
+        std::vector<Chunk> chunks; // By index; filled in by sortIntoChunks
+        int particlePool;
+
+        Layout() : particlePool(500) {}
+    };
+
+    const char* const DEFAULT_PATH = "village.scene";
+
+    int chunkOf(float x);
+    float chunkStart(int index);
+
+    VillagerSpot villagerAt(float x); // Default home range
+    AnimalSpot animalAt(AnimalType type, float x, float y);
+
+    // Orders every array by chunk (stable, so a single-chunk layout keeps its
+    // order) and rebuilds the chunk table
+    void sortIntoChunks(Layout& layout);
+
+    // The hand-placed demo village (used when no scene file is given or found)
+    const Layout& builtin();
+
+    // Loads path through its cache (rebuilding the cache when stale). fromCache
+    // tells which one was used; errors are reported on stderr.
+    bool load(const char* path, Layout& out, bool* fromCache = nullptr);
+
+    // Writes layout in the text format (generated villages, editing round trips)
+    bool save(const char* path, const Layout& layout);
+
+    std::string cachePath(const char* path);
+}
+
+#endif // SCENE_FILE_H
@@ -0,0 +1,440 @@
+#include "Snapshot.h"
+#include "Scene.h"
+#include "Stream.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Snapshot {
+
+    namespace {
+        const uint32_t MAGIC = 0x50534e56; // "VNSP"
+        const uint32_t VERSION = 6;
+
+        enum SectionId {
+            SCALARS, HOUSES, VILLAGERS, ANIMALS, EMITTERS, LIGHTS, FREE_LIGHTS,
+            WEATHER_PARTICLES, PARTICLES, EVENT_NAME, HEATMAP, DECORATIONS,
+            STREAM_CHUNKS, STREAM_PARCELS, // Empty unless the world was streamed
+            SECTION_COUNT
+        };
+
+        struct FileHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t sectionCount;
+            uint32_t reserved;
+            uint64_t fileSize;
+        };
+
+        struct SectionHeader {
+            uint32_t id;
+            uint32_t elemSize; // sizeof the struct that wrote it
+            uint64_t count;
+            uint64_t offset;   // From the start of the file, 8-byte aligned
+        };
+
+        // Everything in State that is not an array
+        struct Scalars {
+            unsigned long long rngState;
+            long long tick;
+            bool lod;
+            float timeOfDay, timeSpeed;
+            int season;
+            float seasonTimer;
+            bool isDay, showClouds, showBirds, showStars;
+            Utils::Color skyTop, skyBottom, ambientLight;
+            float boatX, sunX, starTwinkleOffset, waveOffset;
+            float clouds[3][5]; // CloudLayer x, y, speed, scale, alpha
+            int spawnBatch;
+            float currentWindSway;
+
+            int weatherType;
+            float weatherIntensity, windStrength, fogDensity, lightningTimer, transitionTimer;
+            bool isLightningActive, holdWeather;
+
+            CameraSystem::CameraState camera;
+
+            int eventType;
+            float eventTimer;
+            bool eventActive;
+
+            int activeLights;
+            bool lightsNight, lightScheduleKnown;
+
+            float heatPeak, heatOriginX;
+
+            unsigned long long streamKey; // WorldStream::layoutKey() of a streamed world, else 0
+        };
+
+        static_assert(std::is_trivially_copyable<Scalars>::value, "snapshot sections must be raw copies");
+        static_assert(std::is_trivially_copyable<BuildingProps>::value, "snapshot sections must be raw copies");
+        static_assert(std::is_trivially_copyable<Character>::value, "snapshot sections must be raw copies");
+        static_assert(std::is_trivially_copyable<Animal>::value, "snapshot sections must be raw copies");
+        static_assert(std::is_trivially_copyable<LightSource>::value, "snapshot sections must be raw copies");
+        static_assert(std::is_trivially_copyable<WeatherParticle>::value, "snapshot sections must be raw copies");
+        static_assert(std::is_trivially_copyable<Particle>::value, "snapshot sections must be raw copies");
+        static_assert(std::is_trivially_copyable<ParticleEmitter>::value, "snapshot sections must be raw copies");
+        static_assert(std::is_trivially_copyable<Decoration>::value, "snapshot sections must be raw copies");
+        static_assert(std::is_trivially_copyable<WorldStream::SavedChunk>::value, "snapshot sections must be raw copies");
+
+        std::thread writer;
+        bool exitHookInstalled = false;
+
+        // --- Capture ---
+        struct Builder {
+            std::vector<unsigned char> bytes;
+            SectionHeader sections[SECTION_COUNT];
+            int count;
+
+            Builder() : count(0) {
+                bytes.resize(sizeof(FileHeader) + sizeof(SectionHeader) * SECTION_COUNT);
+            }
+
+            void add(SectionId id, const void* data, size_t elemSize, size_t n) {
+                size_t offset = (bytes.size() + 7) & ~size_t(7);
+                bytes.resize(offset + elemSize * n);
+                if (n) memcpy(&bytes[offset], data, elemSize * n);
+                SectionHeader h = { uint32_t(id), uint32_t(elemSize), uint64_t(n), uint64_t(offset) };
+                sections[count++] = h;
+            }
+
+            template <typename List>
+            void addList(SectionId id, const List& list) {
+                add(id, list.data(), sizeof(typename List::value_type), list.size());
+            }
+
+            void finish() {
+                FileHeader fh = { MAGIC, VERSION, uint32_t(count), 0, uint64_t(bytes.size()) };
+                memcpy(&bytes[0], &fh, sizeof(fh));
+                memcpy(&bytes[sizeof(fh)], sections, sizeof(SectionHeader) * count);
+            }
+        };
+
+        void captureScalars(const Scene::State& s, Scalars& c) {
+            memset((void*)&c, 0, sizeof(c)); // Padding too, so identical states give identical files
+            c.rngState = Utils::getRandomState();
+            c.tick = s.tick;
+            c.lod = s.lod;
+            c.timeOfDay = s.timeOfDay;
+            c.timeSpeed = s.timeSpeed;
+            c.season = int(s.currentSeason);
+            c.seasonTimer = s.seasonTimer;
+            c.isDay = s.isDay;
+            c.showClouds = s.showClouds;
+            c.showBirds = s.showBirds;
+            c.showStars = s.showStars;
+            c.skyTop = s.skyTop;
+            c.skyBottom = s.skyBottom;
+            c.ambientLight = s.ambientLight;
+            c.boatX = s.boatX;
+            c.sunX = s.sunX;
+            c.starTwinkleOffset = s.starTwinkleOffset;
+            c.waveOffset = s.waveOffset;
+            for (int i = 0; i < 3; i++) {
+                const Scene::CloudLayer& l = s.layers[i];
+                c.clouds[i][0] = l.x; c.clouds[i][1] = l.y; c.clouds[i][2] = l.speed;
+                c.clouds[i][3] = l.scale; c.clouds[i][4] = l.alpha;
+            }
+            c.spawnBatch = s.spawnBatch;
+            c.currentWindSway = s.currentWindSway;
+
+            c.weatherType = int(s.weather.currentType);
+            c.weatherIntensity = s.weather.intensity;
+            c.windStrength = s.weather.windStrength;
+            c.fogDensity = s.weather.fogDensity;
+            c.lightningTimer = s.weather.lightningTimer;
+            c.transitionTimer = s.weather.transitionTimer;
+            c.isLightningActive = s.weather.isLightningActive;
+            c.holdWeather = s.weather.holdType;
+
+            c.camera = s.camera;
+
+            c.eventType = int(s.events.currentEvent);
+            c.eventTimer = s.events.eventTimer;
+            c.eventActive = s.events.isActive;
+
+            c.activeLights = s.lights.activeCount;
+            c.lightsNight = s.lights.isNight;
+            c.lightScheduleKnown = s.lights.scheduleKnown;
+
+            c.heatPeak = s.heatmap.peak;
+            c.heatOriginX = s.heatmap.originX;
+        }
+
+        void restoreScalars(const Scalars& c, Scene::State& s) {
+            Utils::setRandomState(c.rngState);
+            s.tick = c.tick;
+            s.lod = c.lod;
+            s.timeOfDay = c.timeOfDay;
+            s.timeSpeed = c.timeSpeed;
+            s.currentSeason = (Utils::Season)c.season;
+            s.seasonTimer = c.seasonTimer;
+            s.isDay = c.isDay;
+            s.showClouds = c.showClouds;
+            s.showBirds = c.showBirds;
+            s.showStars = c.showStars;
+            s.skyTop = c.skyTop;
+            s.skyBottom = c.skyBottom;
+            s.ambientLight = c.ambientLight;
+            s.boatX = c.boatX;
+            s.sunX = c.sunX;
+            s.starTwinkleOffset = c.starTwinkleOffset;
+            s.waveOffset = c.waveOffset;
+            for (int i = 0; i < 3; i++) {
+                s.layers[i] = Scene::CloudLayer(c.clouds[i][0], c.clouds[i][1], c.clouds[i][2], c.clouds[i][3], c.clouds[i][4]);
+            }
+            s.spawnBatch = c.spawnBatch;
+            s.currentWindSway = c.currentWindSway;
+
+            s.weather.currentType = (WeatherType)c.weatherType;
+            s.weather.intensity = c.weatherIntensity;
+            s.weather.windStrength = c.windStrength;
+            s.weather.fogDensity = c.fogDensity;
+            s.weather.lightningTimer = c.lightningTimer;
+            s.weather.transitionTimer = c.transitionTimer;
+            s.weather.isLightningActive = c.isLightningActive;
+            s.weather.holdType = c.holdWeather;
+
+            s.camera = c.camera;
+
+            s.events.currentEvent = (EventType)c.eventType;
+            s.events.eventTimer = c.eventTimer;
+            s.events.isActive = c.eventActive;
+
+            s.lights.activeCount = c.activeLights;
+            s.lights.isNight = c.lightsNight;
+            s.lights.scheduleKnown = c.lightScheduleKnown;
+            s.lights.revision++; // Contents changed under any cached lightmap
+
+            s.heatmap.peak = c.heatPeak;
+            s.heatmap.originX = c.heatOriginX;
+        }
+
+        void writeFile(std::string path, std::vector<unsigned char> bytes) {
+            // Write beside the target and rename, so a reader never maps a half-written file
+            std::string tmp = path + ".tmp";
+            FILE* f = fopen(tmp.c_str(), "wb");
+            if (!f) {
+                fprintf(stderr, "Snapshot: cannot write %s\n", tmp.c_str());
+                return;
+            }
+            bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+            ok = (fclose(f) == 0) && ok;
+            remove(path.c_str());
+            if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+                fprintf(stderr, "Snapshot: failed writing %s\n", path.c_str());
+            }
+        }
+
+        // --- Mapping ---
+        struct Mapping {
+            const unsigned char* data;
+            size_t size;
+#ifdef _WIN32
+            HANDLE file, map;
+#endif
+        };
+
+        bool mapFile(const char* path, Mapping& m) {
+#ifdef _WIN32
+            m.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (m.file == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER size;
+            GetFileSizeEx(m.file, &size);
+            m.size = size_t(size.QuadPart);
+            m.map = CreateFileMappingA(m.file, NULL, PAGE_READONLY, 0, 0, NULL);
+            m.data = m.map ? (const unsigned char*)MapViewOfFile(m.map, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (!m.data) {
+                if (m.map) CloseHandle(m.map);
+                CloseHandle(m.file);
+                return false;
+            }
+            return true;
+#else
+            int fd = open(path, O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+            void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (p == MAP_FAILED) return false;
+            m.data = (const unsigned char*)p;
+            m.size = size_t(st.st_size);
+            return true;
+#endif
+        }
+
+        void unmapFile(Mapping& m) {
+#ifdef _WIN32
+            UnmapViewOfFile(m.data);
+            CloseHandle(m.map);
+            CloseHandle(m.file);
+#else
+            munmap((void*)m.data, m.size);
+#endif
+        }
+
+        // Section lookup with layout checks
+        const SectionHeader* findSection(const Mapping& m, const FileHeader& fh, SectionId id, size_t elemSize) {
+            const SectionHeader* sections = (const SectionHeader*)(m.data + sizeof(FileHeader));
+            for (uint32_t i = 0; i < fh.sectionCount; i++) {
+                const SectionHeader& s = sections[i];
+                if (s.id != uint32_t(id)) continue;
+                // Offsets and counts come from the file: bound them without sums that could wrap
+                if (s.elemSize != elemSize || s.offset > m.size || s.count > (m.size - s.offset) / elemSize) return nullptr;
+                return &s;
+            }
+            return nullptr;
+        }
+
+        template <typename T>
+        const T* sectionData(const Mapping& m, const SectionHeader* s) {
+            return (const T*)(m.data + s->offset);
+        }
+    }
+
+    bool save(const char* path) {
+        Scene::State& s = Scene::getState();
+
+        // 1. Capture on the simulation thread (plain memcpy of each array, dormant timers brought up to date)
+        Dormancy::settle(s);
+        Builder b;
+        Scalars scalars;
+        captureScalars(s, scalars);
+        scalars.streamKey = WorldStream::layoutKey();
+        b.add(SCALARS, &scalars, sizeof(scalars), 1);
+        b.addList(HOUSES, s.houses);
+        b.addList(VILLAGERS, s.villagers);
+        b.addList(ANIMALS, s.animals);
+        b.addList(EMITTERS, s.emitters);
+        b.addList(LIGHTS, s.lights.lights);
+        b.addList(FREE_LIGHTS, s.lights.freeSlots);
+        b.addList(WEATHER_PARTICLES, s.weather.particles);
+        b.addList(PARTICLES, s.particles.pool);
+        b.add(EVENT_NAME, s.events.currentEventName.data(), 1, s.events.currentEventName.size());
+        b.addList(HEATMAP, s.heatmap.density);
+        b.addList(DECORATIONS, s.decorations);
+
+        // A streamed world's state is its live chunks; the stored ones go along as spilled
+        std::vector<WorldStream::SavedChunk> streamChunks;
+        std::vector<char> parcels;
+        WorldStream::save(streamChunks, parcels);
+        b.addList(STREAM_CHUNKS, streamChunks);
+        b.addList(STREAM_PARCELS, parcels);
+        b.finish();
+
+        // 2. Disk I/O on the writer thread
+        wait();
+        writer = std::thread(writeFile, std::string(path), std::move(b.bytes));
+        if (!exitHookInstalled) {
+            atexit(wait); // Finish the file on ESC / window close
+            exitHookInstalled = true;
+        }
+        return true;
+    }
+
+    void wait() {
+        if (writer.joinable()) writer.join();
+    }
+
+    bool load(const char* path) {
+        wait(); // Never map a file we are still writing
+
+        Mapping m;
+        if (!mapFile(path, m)) {
+            fprintf(stderr, "Snapshot: cannot open %s\n", path);
+            return false;
+        }
+
+        // 1. Validate everything before touching the state
+        FileHeader fh;
+        bool ok = m.size >= sizeof(fh);
+        if (ok) {
+            memcpy(&fh, m.data, sizeof(fh));
+            ok = fh.magic == MAGIC && fh.version == VERSION && fh.fileSize == m.size &&
+                 sizeof(FileHeader) + sizeof(SectionHeader) * fh.sectionCount <= m.size;
+        }
+
+        const SectionHeader* sec[SECTION_COUNT] = {};
+        if (ok) {
+            sec[SCALARS] = findSection(m, fh, SCALARS, sizeof(Scalars));
+            sec[HOUSES] = findSection(m, fh, HOUSES, sizeof(BuildingProps));
+            sec[VILLAGERS] = findSection(m, fh, VILLAGERS, sizeof(Character));
+            sec[ANIMALS] = findSection(m, fh, ANIMALS, sizeof(Animal));
+            sec[EMITTERS] = findSection(m, fh, EMITTERS, sizeof(ParticleEmitter));
+            sec[LIGHTS] = findSection(m, fh, LIGHTS, sizeof(LightSource));
+            sec[FREE_LIGHTS] = findSection(m, fh, FREE_LIGHTS, sizeof(LightHandle));
+            sec[WEATHER_PARTICLES] = findSection(m, fh, WEATHER_PARTICLES, sizeof(WeatherParticle));
+            sec[PARTICLES] = findSection(m, fh, PARTICLES, sizeof(Particle));
+            sec[EVENT_NAME] = findSection(m, fh, EVENT_NAME, 1);
+            sec[HEATMAP] = findSection(m, fh, HEATMAP, sizeof(float));
+            sec[DECORATIONS] = findSection(m, fh, DECORATIONS, sizeof(Decoration));
+            sec[STREAM_CHUNKS] = findSection(m, fh, STREAM_CHUNKS, sizeof(WorldStream::SavedChunk));
+            sec[STREAM_PARCELS] = findSection(m, fh, STREAM_PARCELS, 1);
+            for (int i = 0; i < SECTION_COUNT; i++) ok = ok && sec[i] && (i != SCALARS || sec[i]->count == 1);
+        }
+        if (!ok) {
+            fprintf(stderr, "Snapshot: %s is not a snapshot from this build (version %u)\n", path, VERSION);
+            unmapFile(m);
+            return false;
+        }
+
+        // A streamed world resumes streaming, which takes the village it was saved from
+        Scalars scalars;
+        memcpy(&scalars, m.data + sec[SCALARS]->offset, sizeof(scalars));
+        const WorldStream::SavedChunk* streamChunks = sectionData<WorldStream::SavedChunk>(m, sec[STREAM_CHUNKS]);
+        const char* parcels = sectionData<char>(m, sec[STREAM_PARCELS]);
+        if (scalars.streamKey && !WorldStream::resumable(scalars.streamKey, streamChunks, size_t(sec[STREAM_CHUNKS]->count),
+                                                         parcels, size_t(sec[STREAM_PARCELS]->count))) {
+            fprintf(stderr, "Snapshot: %s is of a streamed village; load it into the same one (same --scene or --generate options)\n", path);
+            unmapFile(m);
+            return false;
+        }
+
+        // 2. Bulk copies straight out of the mapping. A snapshot of a whole
+        // world ends streaming (if any), a streamed one takes it over below
+        if (!scalars.streamKey) WorldStream::stop();
+        Scene::State& s = Scene::getState();
+        s.dormant = Dormancy::Lists(); // Made afresh on the next step
+        const BuildingProps* houses = sectionData<BuildingProps>(m, sec[HOUSES]);
+        s.houses.assign(houses, houses + sec[HOUSES]->count);
+        const Character* villagers = sectionData<Character>(m, sec[VILLAGERS]);
+        s.villagers.assign(villagers, villagers + sec[VILLAGERS]->count);
+        const Animal* animals = sectionData<Animal>(m, sec[ANIMALS]);
+        s.animals.assign(animals, animals + sec[ANIMALS]->count);
+        const ParticleEmitter* emitters = sectionData<ParticleEmitter>(m, sec[EMITTERS]);
+        s.emitters.assign(emitters, emitters + sec[EMITTERS]->count);
+        const LightSource* lights = sectionData<LightSource>(m, sec[LIGHTS]);
+        s.lights.lights.assign(lights, lights + sec[LIGHTS]->count);
+        const LightHandle* freeSlots = sectionData<LightHandle>(m, sec[FREE_LIGHTS]);
+        s.lights.freeSlots.assign(freeSlots, freeSlots + sec[FREE_LIGHTS]->count);
+        const WeatherParticle* drops = sectionData<WeatherParticle>(m, sec[WEATHER_PARTICLES]);
+        s.weather.particles.assign(drops, drops + sec[WEATHER_PARTICLES]->count);
+        ParticleSystem::restorePool(s.particles, sectionData<Particle>(m, sec[PARTICLES]), int(sec[PARTICLES]->count));
+        s.events.currentEventName.assign(sectionData<char>(m, sec[EVENT_NAME]), size_t(sec[EVENT_NAME]->count));
+        const float* heat = sectionData<float>(m, sec[HEATMAP]);
+        s.heatmap.density.assign(heat, heat + sec[HEATMAP]->count);
+        const Decoration* decorations = sectionData<Decoration>(m, sec[DECORATIONS]);
+        s.decorations.assign(decorations, decorations + sec[DECORATIONS]->count);
+
+        restoreScalars(scalars, s);
+        if (scalars.streamKey) WorldStream::resume(streamChunks, size_t(sec[STREAM_CHUNKS]->count), parcels);
+
+        unmapFile(m);
+        return true;
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+// Binary world snapshots.
+// save() copies the whole Scene::State (entities, lights, weather, particle
+// pool, events, camera, RNG) into one buffer of raw struct arrays and hands it
+// to a background thread for writing. load() memory-maps the file, checks the
+// version and struct sizes, and bulk-copies each section back, so there is no
+// per-entity parsing. Snapshots are only valid for the build that wrote them
+// (same struct layouts); anything else is rejected, not converted. A streamed
+// world also saves its stored chunks and WorldStream's bookkeeping, and only
+// loads back into the same village (which goes on streaming).
+namespace Snapshot {
+    const char* const DEFAULT_PATH = "village.snap";
+
+    bool save(const char* path); // Returns once the state is captured
+    bool load(const char* path); // Replaces the current state
+    void wait(); // Blocks until the last save is on disk
+}
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,523 @@
+#include "Stream.h"
+#include "Lod.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+namespace WorldStream {
+
+    namespace {
+        typedef MemoryTracker::Vector<char, MemoryTracker::STREAMING> Buffer;
+
+        static_assert(std::is_trivially_copyable<BuildingProps>::value, "chunks are stored as raw copies");
+        static_assert(std::is_trivially_copyable<Character>::value, "chunks are stored as raw copies");
+        static_assert(std::is_trivially_copyable<Animal>::value, "chunks are stored as raw copies");
+
+        // One unloaded chunk's entities
+        struct Parcel {
+            std::vector<BuildingProps> houses;
+            std::vector<Character> villagers;
+            std::vector<Animal> animals;
+            std::vector<ParticleEmitter> emitters;
+            std::vector<Decoration> decorations;
+        };
+
+        // Stored chunk = counts then the five arrays back to back
+        struct ParcelHeader {
+            uint32_t houses, villagers, animals, emitters, decorations;
+        };
+
+        struct Slot {
+            bool live;
+            long long offset;        // Place in the spill file
+            size_t capacity;         // Reused while the chunk still fits
+            size_t size;
+            std::shared_ptr<Buffer> buffer; // Stored bytes held in memory (guarded by lock)
+            int pendingWrites;       // Guarded by lock; the buffer stays until these are on disk
+            bool reading;            // Prefetch queued (guarded by lock)
+            int houses, villagers, animals; // Summary while stored
+            long long storedTick;    // When it was unloaded
+        };
+
+        struct Job {
+            Slot* slot; // Map nodes stay put, the worker only touches the fields guarded by lock
+            bool write; // Else read (prefetch)
+            std::shared_ptr<Buffer> data;
+            long long offset;
+            size_t size;
+        };
+
+        // Main thread state
+        bool active = false;
+        Scene::WorldConfig config;
+        std::map<int, Slot> slots; // Every chunk that has been live; never erased (the worker holds references)
+        std::vector<int> live;
+        std::vector<int> buffered;  // Stored chunks that may hold a buffer
+        long long spillEnd = 0;
+        long long loads = 0, unloads = 0;
+        int storedCount = 0;
+        int freshCount = 0;
+
+        // Shared with the worker
+        std::mutex lock;
+        std::condition_variable wake;
+        std::deque<Job> jobs;
+        bool quit = false;
+        std::thread worker;
+        std::mutex fileLock;
+        FILE* spill = nullptr;
+
+        // Where an entity belongs
+        int chunkOf(const BuildingProps& h) { return SceneFile::chunkOf(h.x); }
+        int chunkOf(const Character& v) { return SceneFile::chunkOf(v.homeMin); }
+        int chunkOf(const Animal& a) { return SceneFile::chunkOf(a.homeMin); }
+        int chunkOf(const ParticleEmitter& e) { return SceneFile::chunkOf(e.x); }
+        int chunkOf(const Decoration& d) { return SceneFile::chunkOf(d.x); }
+
+        // The spill file of a big village passes 2 GB, beyond a 32-bit long (Windows)
+        bool seekTo(long long offset) {
+#ifdef _WIN32
+            return _fseeki64(spill, offset, SEEK_SET) == 0;
+#else
+            return fseeko(spill, off_t(offset), SEEK_SET) == 0;
+#endif
+        }
+
+        bool readAt(long long offset, void* data, size_t size) {
+            std::lock_guard<std::mutex> guard(fileLock);
+            return seekTo(offset) && fread(data, 1, size, spill) == size;
+        }
+
+        void writeAt(long long offset, const void* data, size_t size) {
+            std::lock_guard<std::mutex> guard(fileLock);
+            if (!seekTo(offset) || fwrite(data, 1, size, spill) != size) {
+                fprintf(stderr, "Stream: spill file write failed\n");
+            }
+        }
+
+        void workerLoop() {
+            std::unique_lock<std::mutex> guard(lock);
+            for (;;) {
+                wake.wait(guard, [] { return quit || !jobs.empty(); });
+                if (jobs.empty()) return; // Quit once drained
+                Job job = jobs.front();
+                jobs.pop_front();
+                guard.unlock();
+
+                if (job.write) {
+                    writeAt(job.offset, job.data->data(), job.size);
+                    guard.lock();
+                    job.slot->pendingWrites--;
+                } else {
+                    std::shared_ptr<Buffer> data = std::make_shared<Buffer>(job.size);
+                    bool ok = readAt(job.offset, data->data(), job.size);
+                    guard.lock();
+                    Slot& s = *job.slot;
+                    s.reading = false;
+                    if (ok && !s.live && !s.buffer) s.buffer = data; // Unless loaded meanwhile
+                }
+            }
+        }
+
+        void enqueue(const Job& job) {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                jobs.push_back(job);
+            }
+            wake.notify_one();
+        }
+
+        // Moves the entities of the given chunks out of list, keeping the order of the rest
+        template <class List>
+        void cut(List& list, const std::vector<int>& chunks, std::vector<Parcel>& parcels,
+                 std::vector<typename List::value_type> Parcel::* field) {
+            size_t kept = 0;
+            for (size_t i = 0; i < list.size(); i++) {
+                auto it = std::find(chunks.begin(), chunks.end(), chunkOf(list[i]));
+                if (it == chunks.end()) {
+                    if (kept != i) list[kept] = list[i];
+                    kept++;
+                } else {
+                    (parcels[it - chunks.begin()].*field).push_back(list[i]);
+                }
+            }
+            list.resize(kept);
+        }
+
+        template <class T>
+        void put(Buffer& out, const std::vector<T>& items) {
+            size_t at = out.size();
+            out.resize(at + items.size() * sizeof(T));
+            if (!items.empty()) memcpy(&out[at], items.data(), items.size() * sizeof(T));
+        }
+
+        template <class List>
+        const char* take(const char* p, uint32_t count, List& list) {
+            size_t at = list.size();
+            list.resize(at + count);
+            if (count) memcpy((void*)&list[at], p, count * sizeof(typename List::value_type));
+            return p + count * sizeof(typename List::value_type);
+        }
+
+        // Stores a serialized chunk: the writer puts it in the spill file, a copy stays in memory until it is on disk
+        void store(int chunk, const std::shared_ptr<Buffer>& data, long long storedTick) {
+            ParcelHeader header;
+            memcpy(&header, data->data(), sizeof(header));
+            Slot& s = slots[chunk];
+            s.size = data->size();
+            if (s.size > s.capacity) {
+                s.offset = spillEnd;
+                s.capacity = s.size;
+                spillEnd += (long long)s.size;
+            }
+            s.houses = int(header.houses);
+            s.villagers = int(header.villagers);
+            s.animals = int(header.animals);
+            s.storedTick = storedTick;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                s.live = false;
+                s.buffer = data;
+                s.pendingWrites++;
+            }
+            buffered.push_back(chunk);
+            enqueue(Job{ &s, true, data, s.offset, s.size });
+            storedCount++;
+        }
+
+        void unload(Scene::State& state, const std::vector<int>& chunks) {
+            // 1. Cut every chunk out in one pass over each array (dormant ones up to date first)
+            Dormancy::settle(state);
+            std::vector<Parcel> parcels(chunks.size());
+            cut(state.houses, chunks, parcels, &Parcel::houses);
+            cut(state.villagers, chunks, parcels, &Parcel::villagers);
+            cut(state.animals, chunks, parcels, &Parcel::animals);
+            cut(state.emitters, chunks, parcels, &Parcel::emitters);
+            cut(state.decorations, chunks, parcels, &Parcel::decorations);
+
+            for (size_t i = 0; i < chunks.size(); i++) {
+                Parcel& p = parcels[i];
+                for (auto& h : p.houses) Building::unregisterLights(h, state.lights);
+
+                // 2. Serialize
+                std::shared_ptr<Buffer> data = std::make_shared<Buffer>();
+                ParcelHeader header = { uint32_t(p.houses.size()), uint32_t(p.villagers.size()), uint32_t(p.animals.size()),
+                                        uint32_t(p.emitters.size()), uint32_t(p.decorations.size()) };
+                data->resize(sizeof(header));
+                memcpy(data->data(), &header, sizeof(header));
+                put(*data, p.houses);
+                put(*data, p.villagers);
+                put(*data, p.animals);
+                put(*data, p.emitters);
+                put(*data, p.decorations);
+
+                // 3. Hand it to the writer
+                store(chunks[i], data, state.tick);
+                unloads++;
+            }
+        }
+
+        // The layout's entry for a chunk, nullptr when the layout has nothing there
+        const SceneFile::Chunk* layoutChunk(int chunk) {
+            const std::vector<SceneFile::Chunk>& table = config.layout->chunks;
+            auto it = std::lower_bound(table.begin(), table.end(), chunk,
+                                       [](const SceneFile::Chunk& c, int v) { return c.index < v; });
+            return (it == table.end() || it->index != chunk) ? nullptr : &*it;
+        }
+
+        // First visit: the layout's entities of the chunk (if it has any)
+        void build(Scene::State& state, int chunk) {
+            const SceneFile::Chunk* entry = layoutChunk(chunk);
+            if (!entry) return;
+            size_t firstVillager = state.villagers.size(), firstAnimal = state.animals.size();
+            Scene::addChunk(state, config, *entry);
+            Lod::catchUp(state, firstVillager, firstAnimal, state.tick); // As if it had been running all along
+            freshCount--;
+        }
+
+        void load(Scene::State& state, int chunk) {
+            Dormancy::settle(state);
+            size_t firstVillager = state.villagers.size(), firstAnimal = state.animals.size();
+            auto found = slots.find(chunk);
+            if (found == slots.end()) {
+                build(state, chunk);
+                slots[chunk].live = true; // Not shared with the worker until it is stored
+                loads++;
+                return;
+            }
+
+            // Stored: from memory when prefetched (or not written yet), else read now
+            Slot& s = found->second;
+            std::shared_ptr<Buffer> data;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                data.swap(s.buffer);
+                s.live = true;
+            }
+            if (!data) {
+                data = std::make_shared<Buffer>(s.size);
+                if (!readAt(s.offset, data->data(), s.size)) {
+                    fprintf(stderr, "Stream: lost chunk %d (spill file read failed)\n", chunk);
+                    storedCount--;
+                    return;
+                }
+            }
+
+            ParcelHeader header;
+            memcpy(&header, data->data(), sizeof(header));
+            const char* p = data->data() + sizeof(header);
+            size_t firstHouse = state.houses.size();
+            p = take(p, header.houses, state.houses);
+            p = take(p, header.villagers, state.villagers);
+            p = take(p, header.animals, state.animals);
+            p = take(p, header.emitters, state.emitters);
+            take(p, header.decorations, state.decorations);
+            for (size_t i = firstHouse; i < state.houses.size(); i++) Building::registerLights(state.houses[i], state.lights);
+            Lod::catchUp(state, firstVillager, firstAnimal, state.tick - s.storedTick);
+
+            storedCount--;
+            loads++;
+        }
+
+        int distance(int a, int b) {
+            return std::abs(a - b);
+        }
+
+        // Spill file and worker; false (nothing started) when no spill file can be made
+        bool open() {
+            spill = tmpfile();
+            if (!spill) return false;
+            static bool exitHookInstalled = false;
+            if (!exitHookInstalled) {
+                atexit(stop); // The worker must be joined before statics go away
+                exitHookInstalled = true;
+            }
+            active = true;
+            quit = false;
+            freshCount = int(config.layout->chunks.size());
+            worker = std::thread(workerLoop);
+            return true;
+        }
+
+        size_t parcelSize(const ParcelHeader& h) {
+            return sizeof(h) + h.houses * sizeof(BuildingProps) + h.villagers * sizeof(Character) +
+                   h.animals * sizeof(Animal) + h.emitters * sizeof(ParticleEmitter) + h.decorations * sizeof(Decoration);
+        }
+
+        template <class T>
+        void mix(uint64_t& key, const T& value) {
+            const unsigned char* p = (const unsigned char*)&value;
+            for (size_t i = 0; i < sizeof(T); i++) key = (key ^ p[i]) * 1099511628211ULL; // FNV-1a
+        }
+    }
+
+    bool wanted(const SceneFile::Layout& layout) {
+        if (layout.chunks.empty()) return false;
+        int span = layout.chunks.back().index - layout.chunks.front().index + 1;
+        return span > 2 * KEEP_RADIUS + 1;
+    }
+
+    void start(Scene::State& state, const Scene::WorldConfig& worldConfig) {
+        stop();
+        config = worldConfig;
+        if (!open()) {
+            fprintf(stderr, "Stream: cannot create a spill file, keeping every chunk live\n");
+            return;
+        }
+
+        // Chunks the world was built with extras in are live from the start, their layout built in too
+        for (const auto& h : state.houses) live.push_back(chunkOf(h));
+        for (const auto& v : state.villagers) live.push_back(chunkOf(v));
+        for (const auto& a : state.animals) live.push_back(chunkOf(a));
+        for (const auto& e : state.emitters) live.push_back(chunkOf(e));
+        std::sort(live.begin(), live.end());
+        live.erase(std::unique(live.begin(), live.end()), live.end());
+        for (int c : live) {
+            build(state, c);
+            slots[c].live = true;
+        }
+        update(state);
+    }
+
+    void stop() {
+        if (!active) return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            quit = true;
+        }
+        wake.notify_one();
+        worker.join();
+        fclose(spill);
+        spill = nullptr;
+
+        active = false;
+        slots.clear();
+        live.clear();
+        buffered.clear();
+        spillEnd = 0;
+        loads = unloads = 0;
+        storedCount = freshCount = 0;
+    }
+
+    bool isActive() {
+        return active;
+    }
+
+    void update(Scene::State& state) {
+        if (!active) return;
+        int center = SceneFile::chunkOf(CameraSystem::viewCenterX(state.camera));
+
+        // 1. Unload what the camera left behind
+        std::vector<int> leaving;
+        for (int c : live) if (distance(c, center) > KEEP_RADIUS) leaving.push_back(c);
+        if (!leaving.empty()) {
+            unload(state, leaving);
+            for (int c : leaving) live.erase(std::find(live.begin(), live.end(), c));
+        }
+
+        // 2. Load the window
+        for (int c = center - LOAD_RADIUS; c <= center + LOAD_RADIUS; c++) {
+            if (std::find(live.begin(), live.end(), c) != live.end()) continue;
+            load(state, c);
+            live.push_back(c);
+        }
+
+        // 3. Read the chunks just past the window ahead of time, drop buffers further out
+        for (int d = LOAD_RADIUS + 1; d <= KEEP_RADIUS + 1; d++) {
+            for (int c : { center - d, center + d }) {
+                auto it = slots.find(c);
+                if (it == slots.end() || it->second.live) continue;
+                Slot& s = it->second;
+                std::lock_guard<std::mutex> guard(lock);
+                if (s.buffer || s.reading) continue;
+                s.reading = true;
+                jobs.push_back(Job{ &s, false, nullptr, s.offset, s.size });
+                wake.notify_one();
+                buffered.push_back(c);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            size_t kept = 0;
+            for (int c : buffered) {
+                Slot& s = slots.find(c)->second;
+                bool keep = !s.live && (distance(c, center) <= KEEP_RADIUS + 1 || s.pendingWrites > 0 || s.reading);
+                if (keep) buffered[kept++] = c;
+                else if (!s.live) s.buffer.reset();
+            }
+            buffered.resize(kept);
+            std::sort(buffered.begin(), buffered.end());
+            buffered.erase(std::unique(buffered.begin(), buffered.end()), buffered.end());
+        }
+    }
+
+    Stats stats() {
+        Stats st = Stats();
+        if (!active) return st;
+        st.liveChunks = int(live.size());
+        st.storedChunks = storedCount;
+        st.freshChunks = freshCount;
+        st.spillBytes = size_t(spillEnd);
+        std::lock_guard<std::mutex> guard(lock);
+        for (int c : buffered) {
+            const Slot& s = slots.find(c)->second;
+            if (s.buffer) st.bufferedBytes += s.buffer->size();
+        }
+        st.loads = loads;
+        st.unloads = unloads;
+        return st;
+    }
+
+    uint64_t layoutKey() {
+        if (!active) return 0;
+        uint64_t key = 14695981039346656037ULL;
+        mix(key, config.houses);
+        mix(key, config.villagers);
+        mix(key, config.animals);
+        mix(key, config.emitters);
+        for (const SceneFile::Chunk& c : config.layout->chunks) mix(key, c);
+        return key;
+    }
+
+    void save(std::vector<SavedChunk>& chunks, std::vector<char>& parcels) {
+        chunks.clear();
+        parcels.clear();
+        if (!active) return;
+        for (auto& entry : slots) {
+            Slot& s = entry.second;
+            SavedChunk c = { int32_t(entry.first), s.live ? 1 : 0, 0, 0 };
+            if (!s.live) {
+                // From memory when buffered, else back from the spill file
+                std::shared_ptr<Buffer> data;
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    data = s.buffer;
+                }
+                size_t at = parcels.size();
+                parcels.resize(at + s.size);
+                if (data) {
+                    memcpy(&parcels[at], data->data(), s.size);
+                } else if (!readAt(s.offset, &parcels[at], s.size)) {
+                    fprintf(stderr, "Stream: chunk %d left out of the snapshot (spill file read failed)\n", entry.first);
+                    parcels.resize(at);
+                    continue;
+                }
+                c.storedTick = s.storedTick;
+                c.size = s.size;
+            }
+            chunks.push_back(c);
+        }
+    }
+
+    bool resumable(uint64_t key, const SavedChunk* chunks, size_t count, const char* parcels, size_t bytes) {
+        if (!active || key != layoutKey()) return false;
+        size_t at = 0;
+        for (size_t i = 0; i < count; i++) {
+            const SavedChunk& c = chunks[i];
+            if (i > 0 && c.index <= chunks[i - 1].index) return false;
+            if (c.live) {
+                if (c.size != 0) return false;
+                continue;
+            }
+            if (c.size < sizeof(ParcelHeader) || c.size > bytes - at) return false;
+            ParcelHeader header;
+            memcpy(&header, parcels + at, sizeof(header));
+            if (parcelSize(header) != c.size) return false;
+            at += size_t(c.size);
+        }
+        return at == bytes;
+    }
+
+    void resume(const SavedChunk* chunks, size_t count, const char* parcels) {
+        stop(); // Keeps config
+        if (!open()) {
+            fprintf(stderr, "Stream: cannot create a spill file, only the live chunks are left\n");
+            return;
+        }
+        for (size_t i = 0; i < count; i++) {
+            const SavedChunk& c = chunks[i];
+            if (layoutChunk(c.index)) freshCount--; // Built already
+            if (c.live) {
+                slots[c.index].live = true;
+                live.push_back(c.index);
+                continue;
+            }
+            store(c.index, std::make_shared<Buffer>(parcels, parcels + c.size), c.storedTick);
+            parcels += c.size;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "Scene.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Camera-driven chunk streaming for the main world.
+// Villages wider than the streaming window only keep the chunks around the
+// camera in Scene::State: those are simulated and drawn as usual. A chunk
+// that falls behind is cut out of the state and serialized (raw structs, the
+// house lights unregistered) and a background thread writes it to a spill
+// file; chunks next to the window are read back ahead of time so panning
+// onto them is a copy. Chunks never visited cost nothing until the camera
+// first reaches them, then they are built from the layout. Either way a
+// chunk coming in has its villagers and animals caught up on the ticks they
+// missed (Lod::catchUp), so it does not look frozen in time.
+//
+// Villagers and animals belong to the chunk their home range starts in
+// (they never leave it), everything else to the chunk it stands in.
+// Loading and unloading happen at the end of a tick on the main thread, so
+// journals replay them exactly; the thread only moves bytes.
+namespace WorldStream {
+    const int LOAD_RADIUS = 1; // Chunks either side of the camera's that are always live
+    const int KEEP_RADIUS = 2; // Live chunks are only unloaded beyond this (no thrashing at a border)
+
+    struct Stats {
+        int liveChunks;
+        int storedChunks;
+        int freshChunks;        // In the layout but never visited
+        size_t spillBytes;      // Spill file size
+        size_t bufferedBytes;   // Stored chunks held in memory (prefetched or not yet written)
+        long long loads;
+        long long unloads;
+    };
+
+    // Whether a layout is too wide to keep live in full
+    bool wanted(const SceneFile::Layout& layout);
+
+    // Takes over the main world, which Scene built without the layout's
+    // entities; the chunks around the camera are loaded right away
+    void start(Scene::State& state, const Scene::WorldConfig& config);
+    void stop(); // The state keeps whatever is live
+
+    bool isActive();
+
+    // End of tick: unload what the camera left behind, load what it reached,
+    // prefetch the next ones
+    void update(Scene::State& state);
+
+    Stats stats();
+
+    // Snapshots: every chunk that has been live, in index order. Stored ones
+    // carry their parcel (the bytes they were spilled as), one after the other
+    struct SavedChunk {
+        int32_t index;
+        int32_t live;
+        int64_t storedTick;
+        uint64_t size; // Parcel bytes, 0 while live
+    };
+
+    // Tells streamed villages apart (layout chunk table and world sizes); 0 while inactive
+    uint64_t layoutKey();
+
+    // Copies the bookkeeping and every stored parcel, reading the spilled ones back
+    void save(std::vector<SavedChunk>& chunks, std::vector<char>& parcels);
+
+    // Whether saved data fits the village streamed right now
+    bool resumable(uint64_t key, const SavedChunk* chunks, size_t count, const char* parcels, size_t bytes);
+
+    // Takes the saved bookkeeping over (the state holds the live chunks already)
+    // and spills the stored parcels afresh; check resumable() first
+    void resume(const SavedChunk* chunks, size_t count, const char* parcels);
+}
+
+#endif // STREAM_H
@@ -1,6 +1,8 @@
 #include "Style.h"
+#include "Memory.h"
 #include <GL/glut.h>
 #include <cmath>
+#include <vector>
 
 namespace Style {
     Utils::Color getSeasonalColor(Utils::Season season, 
@@ -51,26 +53,80 @@ namespace Style {
         return Utils::Color(base.r * ambient.r, base.g * ambient.g, base.b * ambient.b, base.a);
     }
     
-    void drawSoftShadow(float x, float y, float w, float scaleY) {
+    // --- Soft Shadow Pass ---
+    namespace {
+        const int SHADOW_SEGMENTS = 16;
+
+        struct ShadowVertex {
+            GLfloat x, y;
+            GLubyte r, g, b, a;
+        };
+
+        // Unit ellipse rim, computed once and reused by every shadow
+        float rimCos[SHADOW_SEGMENTS];
+        float rimSin[SHADOW_SEGMENTS];
+        bool rimReady = false;
+
+        MemoryTracker::Vector<ShadowVertex, MemoryTracker::RENDER> shadowVerts;
+        MemoryTracker::Vector<GLuint, MemoryTracker::RENDER> shadowIndices;
+
+        void buildRimTemplate() {
+            for (int i = 0; i < SHADOW_SEGMENTS; i++) {
+                float angle = 2.0f * 3.14159f * float(i) / float(SHADOW_SEGMENTS);
+                rimCos[i] = cos(angle);
+                rimSin[i] = sin(angle);
+            }
+            rimReady = true;
+        }
+    }
+
+    void queueSoftShadow(float x, float y, float w, float scaleY) {
+        if (!rimReady) buildRimTemplate();
+
+        // Soft Ellipse: dark center fading to a transparent rim
+        ShadowVertex center = { x, y, 0, 0, 0, 102 }; // 0.4 alpha
+        shadowVerts.push_back(center);
+
+        float h = w * scaleY;
+        for (int i = 0; i < SHADOW_SEGMENTS; i++) {
+            ShadowVertex rim = { x + rimCos[i] * w, y + rimSin[i] * h, 0, 0, 0, 0 };
+            shadowVerts.push_back(rim);
+        }
+    }
+
+    void flushSoftShadows() {
+        if (shadowVerts.empty()) return;
+
+        const size_t vertsPerShadow = SHADOW_SEGMENTS + 1;
+        const size_t indicesPerShadow = SHADOW_SEGMENTS * 3;
+        size_t count = shadowVerts.size() / vertsPerShadow;
+
+        // Index buffer only grows; the fan topology is identical for every shadow
+        while (shadowIndices.size() < count * indicesPerShadow) {
+            GLuint base = GLuint(shadowIndices.size() / indicesPerShadow * vertsPerShadow);
+            for (int i = 0; i < SHADOW_SEGMENTS; i++) {
+                shadowIndices.push_back(base);
+                shadowIndices.push_back(base + 1 + i);
+                shadowIndices.push_back(base + 1 + (i + 1) % SHADOW_SEGMENTS);
+            }
+        }
+
+        // Preserve the caller's blend and color state
+        glPushAttrib(GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        
-        // Soft Ellipse
-        // Outer faded ring
-        glBegin(GL_TRIANGLE_FAN);
-        glColor4f(0.0f, 0.0f, 0.0f, 0.4f); // Center dark
-        glVertex2f(x, y);
-        
-        glColor4f(0.0f, 0.0f, 0.0f, 0.0f); // Edge transparent
-        int segments = 16;
-        for(int i = 0; i <= segments; i++) {
-            float angle = 2.0f * 3.14159f * float(i) / float(segments);
-            float dx = cos(angle) * w;
-            float dy = sin(angle) * w * scaleY;
-            glVertex2f(x + dx, y + dy);
-        }
-        glEnd();
-        
-        glDisable(GL_BLEND);
+
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, sizeof(ShadowVertex), &shadowVerts[0].x);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ShadowVertex), &shadowVerts[0].r);
+        glDrawElements(GL_TRIANGLES, GLsizei(count * indicesPerShadow), GL_UNSIGNED_INT, shadowIndices.data());
+
+        glPopClientAttrib();
+        glPopAttrib();
+
+        shadowVerts.clear();
     }
 }
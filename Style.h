@@ -61,8 +61,11 @@ namespace Style {
     // This ensures all elements "fit" the current lighting mood
     Utils::Color applyAtmosphere(Utils::Color base, float timeOfDay, float weatherIntensity = 0.0f);
     
-    // Soft Shadow Helper
-    void drawSoftShadow(float x, float y, float width, float scaleY);
+    // Soft Shadow Pass
+    // Shadows are queued per entity and drawn together in a single batched call
+    // (one shared ellipse template, instanced by position and scale)
+    void queueSoftShadow(float x, float y, float width, float scaleY);
+    void flushSoftShadows();
 }
 
 #endif // STYLE_H
@@ -0,0 +1,173 @@
+#include "Telemetry.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Telemetry {
+
+    namespace {
+        const unsigned MAGIC = 0x564c4754; // "VLGT"
+        const unsigned VERSION = 1;
+
+        // Layout of the shared block
+        struct Shared {
+            unsigned magic;
+            unsigned version;
+            std::atomic<unsigned> sequence; // Odd while a record is being written
+            std::atomic<int> alive;         // Cleared when the writer closes
+            Record record;
+        };
+
+        Shared* shared = nullptr;
+        char sharedName[64];
+#ifdef _WIN32
+        HANDLE mapping = NULL;
+#endif
+        bool exitHookInstalled = false;
+
+        // "/village_telemetry" -> "Local\village_telemetry" on Windows
+        void platformName(const char* name, char* out, size_t size) {
+#ifdef _WIN32
+            snprintf(out, size, "Local\\%s", name[0] == '/' ? name + 1 : name);
+#else
+            snprintf(out, size, "%s%s", name[0] == '/' ? "" : "/", name);
+#endif
+        }
+
+        const Shared* mapForReading(const char* name) {
+            char path[64];
+            platformName(name, path, sizeof(path));
+#ifdef _WIN32
+            HANDLE h = OpenFileMappingA(FILE_MAP_READ, FALSE, path);
+            if (!h) return nullptr;
+            return (const Shared*)MapViewOfFile(h, FILE_MAP_READ, 0, 0, sizeof(Shared));
+#else
+            int fd = shm_open(path, O_RDONLY, 0);
+            if (fd < 0) return nullptr;
+            void* p = mmap(nullptr, sizeof(Shared), PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            return (p == MAP_FAILED) ? nullptr : (const Shared*)p;
+#endif
+        }
+
+        // Sequence-lock read: retry while a write is in flight or one landed under us
+        bool readRecord(const Shared* s, Record& out) {
+            for (int attempt = 0; attempt < 1000; attempt++) {
+                unsigned before = s->sequence.load(std::memory_order_acquire);
+                if (before & 1) continue;
+                memcpy(&out, (const void*)&s->record, sizeof(Record));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (s->sequence.load(std::memory_order_relaxed) == before) return true;
+            }
+            return false;
+        }
+    }
+
+    bool open(const char* name) {
+        if (shared) return true;
+        platformName(name, sharedName, sizeof(sharedName));
+
+#ifdef _WIN32
+        mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(Shared), sharedName);
+        if (!mapping) return false;
+        void* p = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(Shared));
+        if (!p) { CloseHandle(mapping); mapping = NULL; return false; }
+#else
+        int fd = shm_open(sharedName, O_CREAT | O_RDWR, 0644);
+        if (fd < 0) return false;
+        if (ftruncate(fd, sizeof(Shared)) != 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+#endif
+
+        shared = new (p) Shared();
+        shared->magic = MAGIC;
+        shared->version = VERSION;
+        shared->sequence.store(0, std::memory_order_relaxed);
+        memset(&shared->record, 0, sizeof(Record));
+        shared->alive.store(1, std::memory_order_release);
+
+        if (!exitHookInstalled) {
+            atexit(close);
+            exitHookInstalled = true;
+        }
+        return true;
+    }
+
+    void close() {
+        if (!shared) return;
+        shared->alive.store(0, std::memory_order_release);
+#ifdef _WIN32
+        UnmapViewOfFile(shared);
+        CloseHandle(mapping);
+        mapping = NULL;
+#else
+        munmap(shared, sizeof(Shared));
+        shm_unlink(sharedName); // Readers keep their mapping, new ones fail to open
+#endif
+        shared = nullptr;
+    }
+
+    bool isOpen() {
+        return shared != nullptr;
+    }
+
+    void publish(const Record& r) {
+        if (!shared) return;
+        unsigned seq = shared->sequence.load(std::memory_order_relaxed);
+        shared->sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy((void*)&shared->record, &r, sizeof(Record));
+        shared->sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    int tail(const char* name, int intervalMs) {
+        const char* weatherNames[4] = { "clear", "rain", "snow", "storm" };
+        const char* seasonNames[4] = { "spring", "summer", "autumn", "winter" };
+
+        // 1. Wait for the simulation to create the block
+        const Shared* s = nullptr;
+        for (int waited = 0; !(s = mapForReading(name)); waited++) {
+            if (waited == 0) fprintf(stderr, "waiting for %s ...\n", name);
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        }
+        if (s->magic != MAGIC || s->version != VERSION) {
+            fprintf(stderr, "%s: not a village telemetry block (version %u)\n", name, s->version);
+            return 1;
+        }
+
+        // 2. Print whenever the tick moved on
+        long long lastTick = -1;
+        Record r;
+        while (s->alive.load(std::memory_order_acquire)) {
+            if (readRecord(s, r) && r.tick != lastTick) {
+                lastTick = r.tick;
+                printf("tick %8lld  %5.1f fps  tick %6.3f ms (p99 %6.3f)  ents %d/%d/%d  parts %6d  %5.2fh %s %s %.1f  mem %.2f MB",
+                       r.tick, r.fps, r.tickTimeMs, r.tickP99Ms, r.villagers, r.animals, r.houses, r.particles,
+                       r.timeOfDay, seasonNames[r.season & 3], weatherNames[r.weather & 3], r.weatherIntensity, r.memoryMB);
+                if (r.eventActive) printf("  event %d", r.event);
+                for (int i = 0; i < r.stageCount && i < MAX_STAGES; i++) {
+                    if (r.stages[i].depth == 1) printf("  %s %.3f", r.stages[i].name, r.stages[i].ms);
+                }
+                printf("\n");
+                fflush(stdout);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        }
+        printf("simulation exited\n");
+        return 0;
+    }
+}
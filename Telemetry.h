@@ -0,0 +1,53 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+// Live telemetry in shared memory.
+// Once per tick the simulation copies a fixed-layout Record into a named
+// shared-memory block guarded by a sequence lock: the writer never waits and
+// readers (the dashboard, or village.exe --telemetry-tail) simply retry when
+// they catch a write in progress.
+namespace Telemetry {
+    const char* const DEFAULT_NAME = "/village_telemetry";
+    const int MAX_STAGES = 16;
+
+    struct Stage {
+        char name[24];
+        int depth;
+        float ms; // Last completed frame
+    };
+
+    // Plain data only: the layout is shared with other processes
+    struct Record {
+        long long tick;
+        long long timestampNs; // Steady clock of the writer
+        float fps;
+        float frameTimeMs;
+        float tickTimeMs;
+        float tickP99Ms;
+        float memoryMB;
+        int villagers;
+        int animals;
+        int houses;
+        int particles;
+        int weather; // WeatherType
+        float weatherIntensity;
+        float windStrength;
+        float timeOfDay;
+        int season;  // Utils::Season
+        int event;   // EventType
+        int eventActive;
+        int stageCount;
+        Stage stages[MAX_STAGES];
+    };
+
+    // Writer side (the simulation)
+    bool open(const char* name = DEFAULT_NAME); // Creates the block, unlinked again on exit
+    void close();
+    bool isOpen();
+    void publish(const Record& r); // Never blocks
+
+    // Reader side: prints a line per new tick until the writer exits
+    int tail(const char* name, int intervalMs);
+}
+
+#endif // TELEMETRY_H
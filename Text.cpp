@@ -0,0 +1,164 @@
+#include "Text.h"
+#include "Memory.h"
+#include <GL/glut.h>
+#include <cstdarg>
+#include <cstdio>
+#include <vector>
+
+namespace TextRenderer {
+
+    namespace {
+        // Atlas: 16 x 6 cells of 16x16 pixels for ASCII 32..127
+        const int FIRST_CHAR = 32;
+        const int GLYPH_COUNT = 96;
+        const int CELL = 16;
+        const int ATLAS_COLS = 16;
+        const int ATLAS_W = 256;
+        const int ATLAS_H = 128;
+        const int BASELINE = 4; // Pixels below the baseline inside a cell (descenders)
+        
+        struct TextVertex {
+            GLfloat x, y;
+            GLfloat u, v;
+            GLubyte r, g, b, a;
+        };
+        
+        void* atlasFont = nullptr;
+        GLuint atlasTexture = 0;
+        int glyphWidth[GLYPH_COUNT];
+        MemoryTracker::Vector<TextVertex, MemoryTracker::RENDER> batch;
+        
+        GLubyte toByte(float c) {
+            if (c <= 0.0f) return 0;
+            if (c >= 1.0f) return 255;
+            return GLubyte(c * 255.0f + 0.5f);
+        }
+    }
+
+    void init(void* font) {
+        atlasFont = font;
+        for (int i = 0; i < GLYPH_COUNT; ++i) glyphWidth[i] = glutBitmapWidth(font, FIRST_CHAR + i);
+    }
+    
+    void bake() {
+        if (atlasTexture != 0 || !atlasFont) return;
+        
+        // 1. Rasterize every glyph once with GLUT into the back buffer (the frame clears it after)
+        glPushAttrib(GL_ALL_ATTRIB_BITS);
+        glMatrixMode(GL_PROJECTION);
+        glPushMatrix();
+        glLoadIdentity();
+        gluOrtho2D(0, ATLAS_W, 0, ATLAS_H);
+        glMatrixMode(GL_MODELVIEW);
+        glPushMatrix();
+        glLoadIdentity();
+        
+        glViewport(0, 0, ATLAS_W, ATLAS_H);
+        glDisable(GL_BLEND);
+        glDisable(GL_TEXTURE_2D);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glColor3f(1.0f, 1.0f, 1.0f);
+        
+        for (int i = 0; i < GLYPH_COUNT; ++i) {
+            glRasterPos2f(float((i % ATLAS_COLS) * CELL), float((i / ATLAS_COLS) * CELL + BASELINE));
+            glutBitmapCharacter(atlasFont, FIRST_CHAR + i);
+        }
+        
+        // 2. Read back the coverage and keep it as an alpha texture
+        std::vector<GLubyte> pixels(ATLAS_W * ATLAS_H);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadBuffer(GL_BACK);
+        glReadPixels(0, 0, ATLAS_W, ATLAS_H, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        
+        glGenTextures(1, &atlasTexture);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, ATLAS_W, ATLAS_H, 0, GL_ALPHA, GL_UNSIGNED_BYTE, pixels.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+        
+        glClear(GL_COLOR_BUFFER_BIT);
+        glMatrixMode(GL_PROJECTION);
+        glPopMatrix();
+        glMatrixMode(GL_MODELVIEW);
+        glPopMatrix();
+        glPopAttrib();
+    }
+    
+    bool isReady() {
+        return atlasTexture != 0;
+    }
+
+    void add(float x, float y, const char* text, const Utils::Color& color) {
+        GLubyte r = toByte(color.r), g = toByte(color.g), b = toByte(color.b), a = toByte(color.a);
+        float penX = x;
+        float y0 = y - BASELINE;
+        float y1 = y0 + CELL;
+        
+        for (const char* c = text; *c != '\0'; c++) {
+            int i = (unsigned char)*c - FIRST_CHAR;
+            if (i < 0 || i >= GLYPH_COUNT) continue;
+            
+            float u0 = float((i % ATLAS_COLS) * CELL) / ATLAS_W;
+            float v0 = float((i / ATLAS_COLS) * CELL) / ATLAS_H;
+            float u1 = u0 + float(CELL) / ATLAS_W;
+            float v1 = v0 + float(CELL) / ATLAS_H;
+            
+            TextVertex quad[4] = {
+                { penX,        y0, u0, v0, r, g, b, a },
+                { penX + CELL, y0, u1, v0, r, g, b, a },
+                { penX + CELL, y1, u1, v1, r, g, b, a },
+                { penX,        y1, u0, v1, r, g, b, a }
+            };
+            batch.insert(batch.end(), quad, quad + 4);
+            penX += glyphWidth[i];
+        }
+    }
+
+    void addf(float x, float y, const Utils::Color& color, const char* fmt, ...) {
+        char buffer[256];
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(buffer, sizeof(buffer), fmt, args);
+        va_end(args);
+        add(x, y, buffer, color);
+    }
+    
+    float measure(const char* text) {
+        float w = 0.0f;
+        for (const char* c = text; *c != '\0'; c++) {
+            int i = (unsigned char)*c - FIRST_CHAR;
+            if (i >= 0 && i < GLYPH_COUNT) w += glyphWidth[i];
+        }
+        return w;
+    }
+
+    void flush() {
+        if (batch.empty()) return;
+        if (atlasTexture == 0) { batch.clear(); return; }
+        
+        glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT);
+        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+        
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, sizeof(TextVertex), &batch[0].x);
+        glTexCoordPointer(2, GL_FLOAT, sizeof(TextVertex), &batch[0].u);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TextVertex), &batch[0].r);
+        glDrawArrays(GL_QUADS, 0, GLsizei(batch.size()));
+        
+        glPopClientAttrib();
+        glPopAttrib();
+        
+        batch.clear();
+    }
+}
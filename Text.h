@@ -0,0 +1,25 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include "Utils.h"
+
+namespace TextRenderer {
+    // Picks the GLUT bitmap font (glyph widths, so measure() works right away)
+    void init(void* font = GLUT_BITMAP_HELVETICA_12);
+    // Bakes printable ASCII of the font into a glyph atlas texture, once. The
+    // glyphs are read back from the framebuffer, which is only defined once
+    // the window is on screen: call at the start of display(), before drawing
+    void bake();
+    bool isReady();
+    
+    // Layout: strings are appended to one vertex batch (screen space, pixels,
+    // y = baseline) and drawn together by flush()
+    void add(float x, float y, const char* text, const Utils::Color& color);
+    void addf(float x, float y, const Utils::Color& color, const char* fmt, ...);
+    float measure(const char* text);
+    
+    // Draws everything queued since the last flush in a single call
+    void flush();
+}
+
+#endif // TEXT_H
@@ -0,0 +1,118 @@
+#include "Trace.h"
+#include "Profiler.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Trace {
+
+    namespace {
+        std::atomic<bool> active(false);
+
+        std::mutex queueMutex;
+        std::condition_variable queueReady;
+        std::vector<Event> pending;
+        bool stopRequested = false;
+
+        std::thread writer;
+        FILE* out = nullptr;
+        long long baseNs = 0;
+        bool firstEvent = true;
+        bool exitHookInstalled = false;
+
+        void writeEvent(const Event& e) {
+            double ts = (e.startNs - baseNs) * 0.001; // Microseconds
+            fputs(firstEvent ? "\n" : ",\n", out);
+            firstEvent = false;
+
+            if (e.phase == 'C') {
+                fprintf(out, "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"value\":%lld}}",
+                        e.name, e.threadId, ts, e.value);
+            } else {
+                fprintf(out, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                        e.name, e.threadId, ts, e.durNs * 0.001);
+            }
+        }
+
+        void writerLoop() {
+            std::vector<Event> batch;
+            for (;;) {
+                bool stopping;
+                {
+                    std::unique_lock<std::mutex> lock(queueMutex);
+                    queueReady.wait(lock, [] { return !pending.empty() || stopRequested; });
+                    batch.swap(pending);
+                    stopping = stopRequested;
+                }
+
+                for (const auto& e : batch) writeEvent(e);
+                batch.clear();
+
+                if (stopping) break;
+            }
+        }
+    }
+
+    bool start(const char* path) {
+        if (active.load()) return true;
+
+        out = fopen(path, "w");
+        if (!out) {
+            fprintf(stderr, "Trace: cannot open %s\n", path);
+            return false;
+        }
+        fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", out);
+
+        baseNs = Profiler::nowNs();
+        firstEvent = true;
+        stopRequested = false;
+        writer = std::thread(writerLoop);
+
+        // ESC quits through exit(); make sure the file is still closed properly
+        if (!exitHookInstalled) {
+            atexit(stop);
+            exitHookInstalled = true;
+        }
+
+        active.store(true);
+        return true;
+    }
+
+    void stop() {
+        if (!active.exchange(false)) return;
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopRequested = true;
+        }
+        queueReady.notify_one();
+        writer.join();
+
+        fputs("\n]}\n", out);
+        fclose(out);
+        out = nullptr;
+    }
+
+    bool isActive() {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    void submit(const Event* events, size_t count) {
+        if (!isActive() || count == 0) return;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            pending.insert(pending.end(), events, events + count);
+        }
+        queueReady.notify_one();
+    }
+
+    void counter(const char* name, long long value) {
+        if (!isActive()) return;
+        Event e = { name, 'C', 0, Profiler::nowNs(), 0, value };
+        submit(&e, 1);
+    }
+}
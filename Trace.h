@@ -0,0 +1,28 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+
+// Trace-event JSON export (chrome://tracing / Perfetto).
+// Profiler scopes and counters are handed over in batches; a background
+// writer thread formats and writes them so capture stays cheap on the
+// simulation thread.
+namespace Trace {
+    struct Event {
+        const char* name; // Must outlive the capture (string literals)
+        char phase;       // 'X' = complete (begin + duration), 'C' = counter
+        int threadId;
+        long long startNs;
+        long long durNs;
+        long long value;  // Counter value
+    };
+
+    bool start(const char* path);
+    void stop(); // Flushes, closes the file and joins the writer
+    bool isActive();
+
+    void submit(const Event* events, size_t count);
+    void counter(const char* name, long long value);
+}
+
+#endif // TRACE_H
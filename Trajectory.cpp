@@ -0,0 +1,425 @@
+#include "Trajectory.h"
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace TrajectoryLog {
+
+    namespace {
+        const uint32_t FILE_MAGIC = 0x4a525456;  // "VTRJ"
+        const uint32_t CHUNK_MAGIC = 0x4b4e4843; // "CHNK"
+        const uint32_t VERSION = 1;
+
+        struct FileHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t positionScale;
+            uint32_t chunkTicks;
+        };
+
+        struct ChunkHeader {
+            uint32_t magic;
+            uint32_t ticks;
+            int64_t firstTick;
+            uint32_t villagers;
+            uint32_t animals;
+            uint64_t payloadBytes;
+        };
+
+        // Raw, uncompressed chunk: tick-major columns (value of entity e at tick t is [t * count + e])
+        struct RawChunk {
+            long long firstTick;
+            int ticks;
+            int villagers;
+            int animals;
+            std::vector<int32_t> columns[COLUMN_COUNT];
+        };
+
+        int columnEntities(const RawChunk& c, int column) {
+            return (column < ANIMAL_X) ? c.villagers : c.animals;
+        }
+
+        // --- Encoding helpers ---
+        uint32_t zigzag(int32_t v) { return (uint32_t(v) << 1) ^ uint32_t(v >> 31); }
+        int32_t unzigzag(uint32_t v) { return int32_t(v >> 1) ^ -int32_t(v & 1); }
+
+        void putVarint(std::vector<unsigned char>& out, uint32_t v) {
+            while (v >= 0x80) {
+                out.push_back((unsigned char)(v | 0x80));
+                v >>= 7;
+            }
+            out.push_back((unsigned char)v);
+        }
+
+        // False when the buffer ends mid-varint
+        bool getVarint(const unsigned char*& p, const unsigned char* end, uint32_t& v) {
+            v = 0;
+            for (int shift = 0; shift < 35; shift += 7) {
+                if (p == end) return false;
+                unsigned char b = *p++;
+                v |= uint32_t(b & 0x7f) << shift;
+                if (!(b & 0x80)) return true;
+            }
+            return true;
+        }
+
+        int bitsNeeded(uint32_t v) {
+            int bits = 0;
+            while (v) { bits++; v >>= 1; }
+            return bits;
+        }
+
+        // Per column, per entity: varint(zigzag(first value)), width byte, (ticks - 1) packed zigzag deltas
+        void encode(const RawChunk& c, std::vector<unsigned char>& out) {
+            std::vector<uint32_t> deltas(c.ticks);
+            for (int col = 0; col < COLUMN_COUNT; col++) {
+                int count = columnEntities(c, col);
+                const std::vector<int32_t>& values = c.columns[col];
+                for (int e = 0; e < count; e++) {
+                    // 1. Deltas along time and the widest one
+                    uint32_t widest = 0;
+                    for (int t = 1; t < c.ticks; t++) {
+                        deltas[t] = zigzag(values[t * count + e] - values[(t - 1) * count + e]);
+                        widest |= deltas[t];
+                    }
+                    int width = bitsNeeded(widest);
+                    putVarint(out, zigzag(values[e]));
+                    out.push_back((unsigned char)width);
+                    if (width == 0) continue; // Unchanged all chunk
+
+                    // 2. Bit-pack (LSB first)
+                    uint64_t acc = 0;
+                    int filled = 0;
+                    for (int t = 1; t < c.ticks; t++) {
+                        acc |= uint64_t(deltas[t]) << filled;
+                        filled += width;
+                        while (filled >= 8) {
+                            out.push_back((unsigned char)acc);
+                            acc >>= 8;
+                            filled -= 8;
+                        }
+                    }
+                    if (filled > 0) out.push_back((unsigned char)acc);
+                }
+            }
+        }
+
+        // False (columns left half filled) when the payload is truncated or corrupt
+        bool decode(const unsigned char* p, const ChunkInfo& info, std::vector<int32_t> columns[COLUMN_COUNT]) {
+            const unsigned char* end = p + info.bytes;
+            for (int col = 0; col < COLUMN_COUNT; col++) {
+                int count = (col < ANIMAL_X) ? info.villagers : info.animals;
+                std::vector<int32_t>& values = columns[col];
+                values.resize(size_t(info.ticks) * count);
+                for (int e = 0; e < count; e++) {
+                    uint32_t first;
+                    if (!getVarint(p, end, first) || p == end) return false;
+                    int32_t v = unzigzag(first);
+                    int width = *p++;
+                    if (width > 32) return false;
+                    values[e] = v;
+
+                    uint64_t acc = 0;
+                    int filled = 0;
+                    uint32_t mask = (width >= 32) ? 0xffffffffu : ((1u << width) - 1);
+                    for (int t = 1; t < info.ticks; t++) {
+                        if (width > 0) {
+                            while (filled < width) {
+                                if (p == end) return false;
+                                acc |= uint64_t(*p++) << filled;
+                                filled += 8;
+                            }
+                            v += unzigzag(uint32_t(acc) & mask);
+                            acc >>= width;
+                            filled -= width;
+                        }
+                        values[size_t(t) * count + e] = v;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // --- Recorder state ---
+        FILE* out = nullptr;
+        RawChunk current;
+        std::mutex queueMutex;
+        std::condition_variable queueReady;
+        std::deque<RawChunk> pending;
+        bool stopRequested = false;
+        std::thread writer;
+        bool exitHookInstalled = false;
+
+        void writerLoop() {
+            std::vector<unsigned char> payload;
+            for (;;) {
+                RawChunk chunk;
+                {
+                    std::unique_lock<std::mutex> lock(queueMutex);
+                    queueReady.wait(lock, [] { return !pending.empty() || stopRequested; });
+                    if (pending.empty()) break; // Stop requested and everything written
+                    chunk = std::move(pending.front());
+                    pending.pop_front();
+                }
+
+                payload.clear();
+                encode(chunk, payload);
+                ChunkHeader h = { CHUNK_MAGIC, uint32_t(chunk.ticks), chunk.firstTick,
+                                  uint32_t(chunk.villagers), uint32_t(chunk.animals), payload.size() };
+                fwrite(&h, sizeof(h), 1, out);
+                fwrite(payload.data(), 1, payload.size(), out);
+            }
+        }
+
+        void submitCurrent() {
+            if (current.ticks == 0) return;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                pending.push_back(std::move(current));
+            }
+            queueReady.notify_one();
+            current = RawChunk();
+            current.ticks = 0;
+        }
+
+        int32_t quantize(float v) {
+            return int32_t(lroundf(v * POSITION_SCALE));
+        }
+    }
+
+    bool start(const char* path) {
+        if (out) return false;
+        out = fopen(path, "wb");
+        if (!out) return false;
+
+        FileHeader h = { FILE_MAGIC, VERSION, uint32_t(POSITION_SCALE), uint32_t(CHUNK_TICKS) };
+        fwrite(&h, sizeof(h), 1, out);
+
+        current = RawChunk();
+        current.ticks = 0;
+        stopRequested = false;
+        writer = std::thread(writerLoop);
+
+        if (!exitHookInstalled) {
+            atexit(stop);
+            exitHookInstalled = true;
+        }
+        return true;
+    }
+
+    void stop() {
+        if (!out) return;
+        submitCurrent();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopRequested = true;
+        }
+        queueReady.notify_one();
+        writer.join();
+        fclose(out);
+        out = nullptr;
+    }
+
+    bool isRecording() {
+        return out != nullptr;
+    }
+
+    void record(long long tick, const CharacterList& villagers, const AnimalList& animals) {
+        if (!out) return;
+
+        // 1. Population change or full chunk closes the current one
+        int nv = int(villagers.size());
+        int na = int(animals.size());
+        if (current.ticks > 0 && (current.ticks == CHUNK_TICKS || nv != current.villagers || na != current.animals)) {
+            submitCurrent();
+        }
+        if (current.ticks == 0) {
+            current.firstTick = tick;
+            current.villagers = nv;
+            current.animals = na;
+            for (int col = 0; col < COLUMN_COUNT; col++) {
+                current.columns[col].reserve(size_t(CHUNK_TICKS) * columnEntities(current, col));
+            }
+        }
+
+        // 2. Append this tick's columns (quantizing only; compression happens on the writer)
+        for (const auto& v : villagers) {
+            current.columns[VILLAGER_X].push_back(quantize(v.x));
+            current.columns[VILLAGER_Y].push_back(quantize(v.y));
+            current.columns[VILLAGER_ACTIVITY].push_back(int32_t(v.currentActivity));
+            current.columns[VILLAGER_DIRECTION].push_back(v.direction);
+        }
+        for (const auto& a : animals) {
+            current.columns[ANIMAL_X].push_back(quantize(a.x));
+            current.columns[ANIMAL_Y].push_back(quantize(a.y));
+            current.columns[ANIMAL_STATE].push_back(int32_t(a.currentState));
+            current.columns[ANIMAL_DIRECTION].push_back(a.direction);
+        }
+        current.ticks++;
+    }
+
+    // --- Reader ---
+    Reader::Reader() : data(nullptr), size(0), cachedChunk(-1), fileHandle(nullptr), mappingHandle(nullptr) {}
+
+    bool open(Reader& r, const char* path) {
+        close(r);
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping) { CloseHandle(file); return false; }
+        r.data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        r.size = size_t(fileSize.QuadPart);
+        r.fileHandle = file;
+        r.mappingHandle = mapping;
+        if (!r.data) { close(r); return false; }
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        r.data = (const unsigned char*)p;
+        r.size = size_t(st.st_size);
+#endif
+
+        // Validate the header and index the chunks (headers only, payloads stay untouched)
+        FileHeader fh;
+        if (r.size < sizeof(fh)) { close(r); return false; }
+        memcpy(&fh, r.data, sizeof(fh));
+        if (fh.magic != FILE_MAGIC || fh.version != VERSION || fh.positionScale != uint32_t(POSITION_SCALE)) {
+            close(r);
+            return false;
+        }
+
+        size_t pos = sizeof(fh);
+        while (pos + sizeof(ChunkHeader) <= r.size) {
+            ChunkHeader ch;
+            memcpy(&ch, r.data + pos, sizeof(ch));
+            if (ch.magic != CHUNK_MAGIC || pos + sizeof(ch) + ch.payloadBytes > r.size) break; // Truncated tail
+            ChunkInfo info = { ch.firstTick, int(ch.ticks), int(ch.villagers), int(ch.animals),
+                               pos + sizeof(ch), size_t(ch.payloadBytes) };
+            r.chunks.push_back(info);
+            pos += sizeof(ch) + ch.payloadBytes;
+        }
+        return true;
+    }
+
+    void close(Reader& r) {
+        if (r.data) {
+#ifdef _WIN32
+            UnmapViewOfFile(r.data);
+#else
+            munmap((void*)r.data, r.size);
+#endif
+        }
+#ifdef _WIN32
+        if (r.mappingHandle) CloseHandle((HANDLE)r.mappingHandle);
+        if (r.fileHandle) CloseHandle((HANDLE)r.fileHandle);
+#endif
+        r.data = nullptr;
+        r.size = 0;
+        r.chunks.clear();
+        r.cachedChunk = -1;
+        r.fileHandle = r.mappingHandle = nullptr;
+    }
+
+    long long firstTick(const Reader& r) {
+        return r.chunks.empty() ? 0 : r.chunks.front().firstTick;
+    }
+
+    long long lastTick(const Reader& r) {
+        return r.chunks.empty() ? -1 : r.chunks.back().firstTick + r.chunks.back().ticks - 1;
+    }
+
+    bool readTick(Reader& r, long long tick, std::vector<Sample>& villagers, std::vector<Sample>& animals) {
+        // 1. Find the chunk (ticks are increasing, so binary search)
+        int lo = 0, hi = int(r.chunks.size()) - 1, found = -1;
+        while (lo <= hi) {
+            int mid = (lo + hi) / 2;
+            const ChunkInfo& c = r.chunks[mid];
+            if (tick < c.firstTick) hi = mid - 1;
+            else if (tick >= c.firstTick + c.ticks) lo = mid + 1;
+            else { found = mid; break; }
+        }
+        if (found < 0) return false;
+
+        // 2. Decode it unless it is the cached one
+        const ChunkInfo& c = r.chunks[found];
+        if (r.cachedChunk != found) {
+            if (!decode(r.data + c.offset, c, r.columns)) {
+                r.cachedChunk = -1;
+                return false;
+            }
+            r.cachedChunk = found;
+        }
+
+        // 3. Pick the tick's row
+        size_t t = size_t(tick - c.firstTick);
+        const float inv = 1.0f / POSITION_SCALE;
+        villagers.resize(c.villagers);
+        for (int e = 0; e < c.villagers; e++) {
+            size_t i = t * c.villagers + e;
+            Sample s = { r.columns[VILLAGER_X][i] * inv, r.columns[VILLAGER_Y][i] * inv,
+                         r.columns[VILLAGER_ACTIVITY][i], r.columns[VILLAGER_DIRECTION][i] };
+            villagers[e] = s;
+        }
+        animals.resize(c.animals);
+        for (int e = 0; e < c.animals; e++) {
+            size_t i = t * c.animals + e;
+            Sample s = { r.columns[ANIMAL_X][i] * inv, r.columns[ANIMAL_Y][i] * inv,
+                         r.columns[ANIMAL_STATE][i], r.columns[ANIMAL_DIRECTION][i] };
+            animals[e] = s;
+        }
+        return true;
+    }
+
+    int printInfo(const char* path) {
+        Reader r;
+        if (!open(r, path)) {
+            fprintf(stderr, "%s: not a trajectory log\n", path);
+            return 1;
+        }
+
+        long long entityTicks = 0;
+        for (const auto& c : r.chunks) entityTicks += (long long)c.ticks * (c.villagers + c.animals);
+        printf("%s: %zu bytes, %zu chunks, ticks %lld..%lld\n", path, r.size, r.chunks.size(), firstTick(r), lastTick(r));
+        if (entityTicks > 0) {
+            double rawBytes = double(entityTicks) * COLUMN_COUNT / 2 * sizeof(int32_t);
+            printf("%lld entity-ticks, %.2f bytes each (%.1fx smaller than raw columns)\n",
+                   entityTicks, double(r.size) / entityTicks, rawBytes / r.size);
+        }
+
+        // First villager's path, a few samples across the run
+        std::vector<Sample> villagers, animals;
+        long long span = lastTick(r) - firstTick(r);
+        for (int i = 0; i <= 4 && span >= 0; i++) {
+            long long tick = firstTick(r) + span * i / 4;
+            if (readTick(r, tick, villagers, animals) && !villagers.empty()) {
+                printf("  tick %lld: villager 0 at (%.2f, %.2f) activity %d dir %d\n",
+                       tick, villagers[0].x, villagers[0].y, villagers[0].state, villagers[0].direction);
+            }
+        }
+        close(r);
+        return 0;
+    }
+}
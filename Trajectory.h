@@ -0,0 +1,75 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Character.h"
+#include "Animal.h"
+
+// Columnar trajectory log of villager and animal state.
+// Each tick appends x, y, activity/state and direction per entity to a raw
+// chunk; full chunks (CHUNK_TICKS ticks, or fewer when the population changes)
+// are compressed and written by a background thread. Positions are quantized
+// to 1/POSITION_SCALE units and every column stores, per entity, a base value
+// followed by bit-packed zigzag deltas, so entities standing still cost almost
+// nothing. The reader memory-maps the file and decodes one chunk at a time.
+namespace TrajectoryLog {
+    const int CHUNK_TICKS = 64;
+    const int POSITION_SCALE = 64;
+
+    enum Column {
+        VILLAGER_X, VILLAGER_Y, VILLAGER_ACTIVITY, VILLAGER_DIRECTION,
+        ANIMAL_X, ANIMAL_Y, ANIMAL_STATE, ANIMAL_DIRECTION,
+        COLUMN_COUNT
+    };
+
+    // Recorder (simulation side)
+    bool start(const char* path);
+    void stop(); // Flushes the partial chunk and joins the writer
+    bool isRecording();
+    void record(long long tick, const CharacterList& villagers, const AnimalList& animals);
+
+    // Reader
+    struct Sample {
+        float x, y;
+        int state;     // Activity for villagers, AnimalState for animals
+        int direction;
+    };
+
+    struct ChunkInfo {
+        long long firstTick;
+        int ticks;
+        int villagers;
+        int animals;
+        size_t offset; // Payload start in the mapped file
+        size_t bytes;
+    };
+
+    struct Reader {
+        const unsigned char* data;
+        size_t size;
+        std::vector<ChunkInfo> chunks;
+
+        // Last decoded chunk (tick-major raw columns)
+        int cachedChunk;
+        std::vector<int32_t> columns[COLUMN_COUNT];
+
+        void* fileHandle;    // Platform handles for the mapping
+        void* mappingHandle;
+
+        Reader();
+    };
+
+    bool open(Reader& r, const char* path);
+    void close(Reader& r);
+    long long firstTick(const Reader& r);
+    long long lastTick(const Reader& r);
+    // False when the tick is not in the file
+    bool readTick(Reader& r, long long tick, std::vector<Sample>& villagers, std::vector<Sample>& animals);
+
+    // Summary of a log file (village.exe --trajectory-info <file>)
+    int printInfo(const char* path);
+}
+
+#endif // TRAJECTORY_H
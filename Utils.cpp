@@ -1,23 +1,100 @@
 #include "Utils.h"
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 
 namespace Utils {
 
     // Math & Random
+    // xorshift64* instead of rand(): the whole generator is one word, so snapshots
+    // and replays can capture and restore it. Each thread has its own stream.
+    static thread_local unsigned long long rngState = 0; // 0 = not seeded yet
+
+    static unsigned long long nextRandom() {
+        if (!rngState) seedRandom((unsigned)time(NULL));
+        rngState ^= rngState >> 12;
+        rngState ^= rngState << 25;
+        rngState ^= rngState >> 27;
+        return rngState * 0x2545F4914F6CDD1DULL;
+    }
+
+    void seedRandom(unsigned seed) {
+        // splitmix64 spreads small seeds over the state (which must never be 0)
+        unsigned long long z = seed + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        rngState = z ? z : 0x9E3779B97F4A7C15ULL;
+    }
+
+    unsigned long long getRandomState() {
+        if (!rngState) nextRandom();
+        return rngState;
+    }
+
+    void setRandomState(unsigned long long s) {
+        rngState = s;
+    }
+
     float random(float min, float max) {
-        static bool seeded = false;
-        if (!seeded) {
-            srand(time(NULL));
-            seeded = true;
-        }
-        return min + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (max - min)));
+        float unit = float(nextRandom() >> 40) * (1.0f / 16777216.0f); // 24 bits -> [0, 1)
+        return min + (max - min) * unit;
+    }
+
+    int randomInt(int n) {
+        return int((nextRandom() >> 32) % (unsigned long long)n);
     }
 
     float lerp(float a, float b, float t) {
         return a + (b - a) * t;
     }
 
+    float addRepeated(float x, float step, long long times) {
+        if (!std::isfinite(x) || !std::isfinite(step)) return (times > 0) ? x + step : x;
+        while (times > 0) {
+            if (x < 0.0f) {
+                float r = addRepeated(-x, -step, times); // Rounding is symmetric (but an exact 0 is +0)
+                return (r == 0.0f) ? 0.0f : -r;
+            }
+            uint32_t xb, sb;
+            memcpy(&xb, &x, sizeof(xb));
+            memcpy(&sb, &step, sizeof(sb));
+            int shift = int(xb >> 23) - int((sb >> 23) & 0xff);
+            if ((xb >> 23) == 0 || ((sb >> 23) & 0xff) == 0 || shift < -24) { x += step; times--; continue; }
+
+            // 1. Between two powers of two floats are evenly spaced: x is a whole number of
+            // spaces (units) and, while the sums stay inside, each step adds the same number
+            // of them (the step rounded to a whole number, unless it is a tie)
+            long long units = (xb & 0x7fffff) | 0x800000;
+            long long m = (sb & 0x7fffff) | 0x800000;
+            if (shift <= 0) {
+                m <<= -shift;
+            } else if (shift > 25) {
+                m = 0;
+            } else {
+                long long rest = m & ((1LL << shift) - 1), half = 1LL << (shift - 1);
+                if (rest == half) { x += step; times--; continue; }
+                m = (m >> shift) + (rest > half ? 1 : 0);
+            }
+            if (sb >> 31) m = -m;
+            if (m == 0) {
+                if (units != 0x800000 || step > 0.0f) return x; // Too small to ever change x
+                x += step; times--; continue; // Except just below a power of two
+            }
+
+            // 2. As many as stay clear of both ends in one go, the step out of the range on its own
+            long long fit = (m < 0) ? (units - 0x800001) / -m : (0xffffff - units) / m;
+            long long n = (fit < times) ? fit : times;
+            if (n <= 0) { x += step; times--; continue; }
+            units += n * m;
+            xb = (xb & 0xff800000u) | uint32_t(units & 0x7fffff);
+            memcpy(&x, &xb, sizeof(x));
+            times -= n;
+        }
+        return x;
+    }
+
     // Drawing Primitives
     void drawCircle(float r, float x, float y, int segments, bool filled) {
         if (filled) glBegin(GL_POLYGON);
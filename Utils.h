@@ -1,7 +1,7 @@
 #ifndef UTILS_H
 #define UTILS_H
 
-#include <GL/glut.h>
+#include "GLStats.h" // GL headers + call counting
 #include <cmath>
 #include <vector>
 
@@ -34,7 +34,14 @@ namespace Utils {
 
     // Math & Random
     float random(float min, float max);
+    int randomInt(int n); // [0, n)
+    void seedRandom(unsigned seed); // Fixed seed for reproducible runs (default: time)
+    unsigned long long getRandomState(); // Capture/restore the calling thread's generator
+    void setRandomState(unsigned long long state);
     float lerp(float a, float b, float t);
+    // x += step, times over, rounding each sum like the loop would (same result)
+    // in a few operations per power of two crossed
+    float addRepeated(float x, float step, long long times);
     
     // Drawing Primitives
     void drawCircle(float r, float x, float y, int segments = 50, bool filled = true);
@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <iostream>
+#include <algorithm>
 
 WeatherState::WeatherState() : 
     currentType(WeatherType::CLEAR), 
@@ -11,7 +12,8 @@ WeatherState::WeatherState() :
     fogDensity(0.0f),
     lightningTimer(0.0f),
     isLightningActive(false),
-    transitionTimer(0.0f)
+    transitionTimer(0.0f),
+    holdType(false)
 {
     particles.resize(500); // 500 particles
 }
@@ -25,30 +27,63 @@ namespace WeatherSystem {
         }
     }
 
+    void setWeather(WeatherState& state, WeatherType type) {
+        state.currentType = type;
+        if (type == WeatherType::CLEAR) {
+            state.intensity = 0.0f;
+            state.windStrength = Utils::random(-0.5f, 0.5f);
+        } else if (type == WeatherType::RAIN) {
+            state.intensity = 0.7f;
+            state.windStrength = Utils::random(1.0f, 3.0f);
+        } else if (type == WeatherType::STORM) {
+            state.intensity = 1.0f;
+            state.windStrength = Utils::random(4.0f, 6.0f);
+        } else { // Snow
+            state.intensity = 0.5f;
+            state.windStrength = Utils::random(-1.0f, 1.0f);
+        }
+    }
+
+    namespace {
+        void pickWeather(WeatherState& state) {
+            int r = Utils::randomInt(100);
+            if (r < 60) setWeather(state, WeatherType::CLEAR);
+            else if (r < 80) setWeather(state, WeatherType::RAIN);
+            else if (r < 90) setWeather(state, WeatherType::STORM);
+            else setWeather(state, WeatherType::SNOW);
+        }
+        
+        // A fresh drop or flake just above the screen
+        void spawn(const WeatherState& state, WeatherParticle& p, int width, int height) {
+            p.active = true;
+            p.x = Utils::random(-20.0f, width + 20.0f); // Screen width coords
+            p.y = height + Utils::random(0.0f, 20.0f); // Above
+            
+            if (state.currentType == WeatherType::SNOW) {
+                p.speedY = Utils::random(0.1f, 0.3f);
+                p.speedX = state.windStrength * 0.2f + Utils::random(-0.1f, 0.1f);
+            } else { // Rain
+                p.speedY = Utils::random(1.0f, 2.5f);
+                p.speedX = state.windStrength * 0.3f;
+            }
+        }
+        
+        void updateFog(WeatherState& state) {
+            if (state.currentType == WeatherType::RAIN || state.currentType == WeatherType::STORM) {
+                state.fogDensity = 0.3f;
+            } else {
+                state.fogDensity = 0.0f;
+            }
+        }
+    }
+
     void update(WeatherState& state, float timeSpeed, int width, int height) { // Updated signature
         state.transitionTimer += timeSpeed;
         
-        // Random Weather Transitions
-        if (state.transitionTimer > 50.0f) { // Every ~50 units of time
+        // Random Weather Transitions (unless a scenario pinned the type)
+        if (state.transitionTimer > 50.0f && !state.holdType) { // Every ~50 units of time
             state.transitionTimer = 0;
-            int r = rand() % 100;
-            if (r < 60) {
-                state.currentType = WeatherType::CLEAR;
-                state.intensity = 0.0f;
-                state.windStrength = Utils::random(-0.5f, 0.5f);
-            } else if (r < 80) {
-                state.currentType = WeatherType::RAIN;
-                state.intensity = 0.7f;
-                state.windStrength = Utils::random(1.0f, 3.0f);
-            } else if (r < 90) { // Storm
-                state.currentType = WeatherType::STORM;
-                state.intensity = 1.0f;
-                state.windStrength = Utils::random(4.0f, 6.0f);
-            } else { // Snow
-                state.currentType = WeatherType::SNOW;
-                state.intensity = 0.5f;
-                state.windStrength = Utils::random(-1.0f, 1.0f);
-            }
+            pickWeather(state);
         }
         
         // Update Particles
@@ -60,17 +95,7 @@ namespace WeatherSystem {
                 // If this particle is meant to be active but isn't, respawn it
                 if (i < size_t(activeCount)) {
                     if (!state.particles[i].active) {
-                        state.particles[i].active = true;
-                        state.particles[i].x = Utils::random(-20.0f, width + 20.0f); // Screen width coords
-                        state.particles[i].y = height + Utils::random(0.0f, 20.0f); // Above
-                        
-                        if (state.currentType == WeatherType::SNOW) {
-                            state.particles[i].speedY = Utils::random(0.1f, 0.3f);
-                            state.particles[i].speedX = state.windStrength * 0.2f + Utils::random(-0.1f, 0.1f);
-                        } else { // Rain
-                            state.particles[i].speedY = Utils::random(1.0f, 2.5f);
-                            state.particles[i].speedX = state.windStrength * 0.3f;
-                        }
+                        spawn(state, state.particles[i], width, height);
                     } else {
                         // Move
                         state.particles[i].y -= state.particles[i].speedY;
@@ -96,7 +121,7 @@ namespace WeatherSystem {
         if (state.currentType == WeatherType::STORM) {
             state.lightningTimer -= 0.1f;
             if (state.lightningTimer <= 0) {
-                 if (rand() % 100 < 2) { // Random flash chance (2%)
+                 if (Utils::randomInt(100) < 2) { // Random flash chance (2%)
                      state.isLightningActive = true;
                      state.lightningTimer = Utils::random(5.0f, 15.0f); // Cooldown
                  }
@@ -104,11 +129,36 @@ namespace WeatherSystem {
         }
         
         // Fog
-        if (state.currentType == WeatherType::RAIN || state.currentType == WeatherType::STORM) {
-            state.fogDensity = 0.3f;
+        updateFog(state);
+    }
+    
+    void skip(WeatherState& state, float timeSpeed, long long ticks, int width, int height) {
+        // 1. Transitions: each draw ignores the weather before it, so only the last one matters
+        long long stormTicks = ticks; // Under the weather as it is now
+        long long first = std::max(1LL, (long long)std::floor((50.0 - state.transitionTimer) / timeSpeed) + 1);
+        if (ticks >= first && !state.holdType) {
+            long long period = (long long)std::floor(50.0 / timeSpeed) + 1; // The timer restarts from 0
+            stormTicks = (ticks - first) % period;
+            state.transitionTimer = timeSpeed * float(stormTicks);
+            pickWeather(state);
         } else {
-            state.fogDensity = 0.0f;
+            state.transitionTimer += timeSpeed * float(ticks);
         }
+        
+        // 2. Particles mid-fall all over the screen
+        int activeCount = (state.currentType != WeatherType::CLEAR) ? int(state.intensity * state.particles.size()) : 0;
+        for (size_t i = 0; i < state.particles.size(); ++i) {
+            state.particles[i].active = false;
+            if (i >= size_t(activeCount)) continue;
+            spawn(state, state.particles[i], width, height);
+            state.particles[i].y = Utils::random(0.0f, float(height));
+        }
+        
+        // 3. Lightning cooldown ran down since the storm began (or the skip did)
+        state.isLightningActive = false;
+        if (state.currentType == WeatherType::STORM) state.lightningTimer -= 0.1f * float(stormTicks);
+        
+        updateFog(state);
     }
     
     void draw(const WeatherState& state, int width, int height) {
@@ -190,4 +240,10 @@ namespace WeatherSystem {
         }
         return baseSway + sin(time * 0.5f) * 0.3f; // Gentle
     }
+
+    float walkSpeedMod(const WeatherState& state) {
+        if (state.currentType == WeatherType::RAIN) return 0.7f;
+        if (state.currentType == WeatherType::STORM) return 0.4f;
+        return 1.0f;
+    }
 }
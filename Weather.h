@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "Utils.h"
+#include "Memory.h"
 
 enum class WeatherType {
     CLEAR,
@@ -30,19 +31,27 @@ struct WeatherState {
 
     // Cycle
     float transitionTimer;
+    bool holdType; // Skip random transitions (benchmarks pin a weather type)
     
-    std::vector<WeatherParticle> particles;
+    MemoryTracker::Vector<WeatherParticle, MemoryTracker::WEATHER> particles;
     
     WeatherState();
 };
 
 namespace WeatherSystem {
     void init(WeatherState& state);
+    void setWeather(WeatherState& state, WeatherType type); // Intensity & wind for the type
     void update(WeatherState& state, float timeSpeed, int width, int height); // Added width/height for particle bounds
+    // ticks of update() at once: the weather of the last transition, particles
+    // spread over the screen instead of streaming in
+    void skip(WeatherState& state, float timeSpeed, long long ticks, int width, int height);
     void draw(const WeatherState& state, int width, int height);
     
     // Helper to get wind sway for trees/grass
     float getWindSway(const WeatherState& state, float time);
+    
+    // Villagers slow down in rain and storms
+    float walkSpeedMod(const WeatherState& state);
 }
 
 #endif // WEATHER_H
@@ -1,9 +1,29 @@
 #include <GL/glut.h>
 #include "Scene.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "GLStats.h"
+#include "Benchmark.h"
+#include "Microbench.h"
+#include "Batch.h"
+#include "Telemetry.h"
+#include "Trajectory.h"
+#include "Snapshot.h"
+#include "Journal.h"
+#include "Fork.h"
+#include "FastForward.h"
+#include "Generator.h"
+#include "SceneFile.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <iostream>
 
 void displayCallback() {
     Scene::display();
+    Profiler::endFrame(); // Close the profiler frame after all display scopes
+    GLStats::endFrame();
 }
 
 void reshapeCallback(int w, int h) {
@@ -17,13 +37,148 @@ void keyboardCallback(unsigned char key, int x, int y) {
 
 
 int main(int argc, char** argv) {
+    // Command line: --bench / --microbench / --fork / --batch / --skip-check / --save-scene [...] run headless instead of the window
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) return Benchmark::run(argc, argv);
+        if (strcmp(argv[i], "--microbench") == 0) return Microbench::run(argc, argv);
+        if (strcmp(argv[i], "--fork") == 0) return WorldFork::run(argc, argv);
+        if (strcmp(argv[i], "--batch") == 0) return Batch::run(argc, argv);
+        if (strcmp(argv[i], "--skip-check") == 0) return FastForward::check(argc, argv);
+        if (strcmp(argv[i], "--save-scene") == 0) return Generator::run(argc, argv);
+        if (strcmp(argv[i], "--telemetry-tail") == 0) {
+            const char* name = (i + 1 < argc) ? argv[i + 1] : Telemetry::DEFAULT_NAME;
+            return Telemetry::tail(name, 100);
+        }
+        if (strcmp(argv[i], "--trajectory-info") == 0 && i + 1 < argc) return TrajectoryLog::printInfo(argv[i + 1]);
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            for (int j = 1; j < argc; j++) {
+                if (strcmp(argv[j], "--headless") == 0) return Journal::runHeadless(argv[i + 1]);
+            }
+        }
+    }
+    
     glutInit(&argc, argv);
+    
+    // Command line: --trace <file.json> captures a trace from the first frame,
+    // --telemetry [name] publishes live metrics to shared memory,
+    // --trajectory <file> logs villager/animal state every tick,
+    // --villagers/--animals/--houses/--emitters/--particles N size the starting world,
+    // --snapshot <file> resumes a saved world instead,
+    // --seed N / --record <file> / --replay <file> for deterministic runs,
+    // --scene <file> loads the village layout (default: village.scene when present),
+    // --generate <seed> builds a procedural one (the size options are its targets)
+    static SceneFile::Layout layout;
+    const char* scenePath = nullptr;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--scene") == 0) scenePath = argv[i + 1];
+    }
+    if (!scenePath) {
+        FILE* f = fopen(SceneFile::DEFAULT_PATH, "r");
+        if (f) {
+            fclose(f);
+            scenePath = SceneFile::DEFAULT_PATH;
+        }
+    }
+    
+    // The layout sets the starting world; the size options below adjust it
+    Scene::WorldConfig world;
+    if (scenePath) {
+        long long startNs = Profiler::nowNs();
+        bool cached = false;
+        if (SceneFile::load(scenePath, layout, &cached)) {
+            world = Scene::WorldConfig(layout);
+            std::cout << "Scene: " << scenePath << (cached ? " (cached), " : ", ")
+                      << (Profiler::nowNs() - startNs) / 1000000.0 << " ms" << std::endl;
+        } else {
+            std::cerr << "Scene: using the built-in village" << std::endl;
+            scenePath = nullptr;
+        }
+    }
+    Generator::Params generated;
+    bool isGenerated = Generator::parseArgs(argc, argv, generated);
+    if (isGenerated) {
+        long long startNs = Profiler::nowNs();
+        Generator::generate(generated, layout);
+        world = Scene::WorldConfig(layout);
+        scenePath = nullptr;
+        std::cout << "Generated village " << generated.seed << ": " << layout.chunks.size() << " chunks, "
+                  << (Profiler::nowNs() - startNs) / 1000000.0 << " ms" << std::endl;
+    }
+    
+    const char* snapshotPath = nullptr;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    unsigned seed = (unsigned)time(NULL);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            Trace::start(argv[++i]);
+        } else if (strcmp(argv[i], "--telemetry") == 0) {
+            const char* name = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : Telemetry::DEFAULT_NAME;
+            if (!Telemetry::open(name)) std::cerr << "Telemetry: cannot create " << name << std::endl;
+        } else if (strcmp(argv[i], "--trajectory") == 0 && i + 1 < argc) {
+            if (!TrajectoryLog::start(argv[++i])) std::cerr << "Trajectory: cannot write " << argv[i] << std::endl;
+        } else if (strcmp(argv[i], "--villagers") == 0 && i + 1 < argc) {
+            world.villagers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--animals") == 0 && i + 1 < argc) {
+            world.animals = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--houses") == 0 && i + 1 < argc) {
+            world.houses = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--emitters") == 0 && i + 1 < argc) {
+            world.emitters = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--particles") == 0 && i + 1 < argc) {
+            world.particlePool = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            snapshotPath = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = unsigned(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if ((strcmp(argv[i], "--scene") == 0 || strcmp(argv[i], "--generate") == 0 || strcmp(argv[i], "--threads") == 0) && i + 1 < argc) {
+            i++; // Handled above
+        }
+    }
+    
+    // A replay takes seed and world from the journal
+    Journal::Header journal;
+    if (replayPath) {
+        if (!Journal::startReplay(replayPath, journal)) {
+            std::cerr << "Replay: cannot read " << replayPath << std::endl;
+            return 1;
+        }
+        seed = journal.seed;
+        world = journal.world;
+        if (!journal.scene.empty()) {
+            if (!SceneFile::load(journal.scene.c_str(), layout)) return 1;
+            world.layout = &layout;
+        }
+    }
+    if (isGenerated && recordPath) {
+        std::cerr << "--record needs a scene file: write the village with --save-scene and load it with --scene" << std::endl;
+        recordPath = nullptr;
+    }
+    if (snapshotPath && (recordPath || replayPath)) {
+        std::cerr << "--snapshot is ignored when recording or replaying (journals start from a generated world)" << std::endl;
+        snapshotPath = nullptr;
+    }
+    Utils::seedRandom(seed);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(600, 600);
     glutInitWindowPosition(100, 100);
     glutCreateWindow("Village Simulator - Terrain & Buildings");
 
-    Scene::init();
+    Scene::init(world);
+    if (snapshotPath) Snapshot::load(snapshotPath);
+    if (replayPath) Scene::resize(journal.width, journal.height);
+    if (recordPath) {
+        journal.seed = seed;
+        journal.world = world;
+        journal.scene = scenePath ? scenePath : "";
+        journal.width = Scene::getState().width;
+        journal.height = Scene::getState().height;
+        if (!Journal::startRecording(recordPath, journal)) std::cerr << "Journal: cannot write " << recordPath << std::endl;
+    }
 
     glutDisplayFunc(displayCallback);
     glutReshapeFunc(reshapeCallback);